@@ -0,0 +1,121 @@
+#include "FailureDatabase.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace proptest {
+
+namespace util {
+
+string getDefaultDatabaseDir()
+{
+    static const char* env_database = std::getenv("PROPTEST_DATABASE");
+    return env_database ? string(env_database) : string();
+}
+
+}  // namespace util
+
+FailureDatabase::FailureDatabase(const string& _directory) : directory(_directory) {}
+
+string FailureDatabase::getPath(const string& name) const
+{
+    // characters not safe in a file name are replaced
+    string fileName = name;
+    for (char& c : fileName) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.')
+            c = '_';
+    }
+    return (std::filesystem::path(directory) / (fileName + ".failures")).string();
+}
+
+vector<StoredFailure> FailureDatabase::load(const string& name) const
+{
+    vector<StoredFailure> failures;
+    std::ifstream file(getPath(name));
+    string line;
+    bool skipping = false;  // fields of an invalid failure record
+    while (std::getline(file, line)) {
+        stringstream fields(line);
+        string key;
+        fields >> key;
+        if (key == "failure") {
+            StoredFailure failure;
+            fields >> failure.seed >> failure.runIndex;
+            skipping = fields.fail();
+            if (skipping) {
+                // a damaged or hand-edited entry shouldn't stop the other failures from being replayed
+                cerr << "skipping invalid failure record in " << getPath(name) << ": " << line << endl;
+                continue;
+            }
+            failures.push_back(failure);
+        } else if (failures.empty() || skipping) {
+            // comments or fields without a failure
+            continue;
+        } else if (key == "run-choices") {
+            uint64_t choice;
+            while (fields >> choice)
+                failures.back().runChoices.push_back(choice);
+        } else if (key == "path") {
+            ShrinkStep step;
+            char separator;
+            while (fields >> step.arg >> separator >> step.index)
+                failures.back().shrinkPath.push_back(step);
+        } else if (key == "choices") {
+            failures.back().byChoices = true;
+            uint64_t choice;
+            while (fields >> choice)
+                failures.back().choices.push_back(choice);
+        } else if (key == "args") {
+            std::getline(fields >> std::ws, failures.back().args);
+        }
+    }
+    return failures;
+}
+
+bool FailureDatabase::save(const string& name, const vector<StoredFailure>& failures) const
+{
+    string path = getPath(name);
+    if (failures.empty()) {
+        error_code ec;
+        std::filesystem::remove(path, ec);
+        return true;
+    }
+
+    // a database that can't be written only loses the failures for the next runs, the test goes on
+    error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    std::ofstream file(path, ios::trunc);
+    if (!file) {
+        cerr << "cannot write failure database file " << path << (ec ? ": " + ec.message() : string()) << endl;
+        return false;
+    }
+    file << "# failures of property " << name << endl;
+    for (const StoredFailure& failure : failures) {
+        file << "failure " << failure.seed << " " << failure.runIndex << endl;
+        if (!failure.runChoices.empty()) {
+            file << "run-choices";
+            for (uint64_t choice : failure.runChoices)
+                file << " " << choice;
+            file << endl;
+        }
+        if (!failure.shrinkPath.empty()) {
+            file << "path";
+            for (const ShrinkStep& step : failure.shrinkPath)
+                file << " " << step.arg << ":" << step.index;
+            file << endl;
+        }
+        if (failure.byChoices) {
+            file << "choices";
+            for (uint64_t choice : failure.choices)
+                file << " " << choice;
+            file << endl;
+        }
+        if (!failure.args.empty()) {
+            string args = failure.args;
+            std::replace(args.begin(), args.end(), '\n', ' ');
+            file << "args " << args << endl;
+        }
+    }
+    return true;
+}
+
+}  // namespace proptest
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "api.hpp"
+#include "util/std.hpp"
+
+namespace proptest {
+
+/**
+ * @brief A step of shrinking: the candidate at `index` in the shrinks of argument `arg` was accepted
+ */
+struct ShrinkStep
+{
+    uint32_t arg;
+    uint64_t index;
+
+    bool operator==(const ShrinkStep& other) const { return arg == other.arg && index == other.index; }
+};
+
+/**
+ * @brief Failure of a property kept in a `FailureDatabase`
+ * @details The failed inputs are regenerated from `seed` and `runIndex`, replaying `runChoices` first if the run was
+ * generated from mutated choices in coverage-guided mode. The shrunk inputs are regenerated from them by following
+ * `shrinkPath`, or from `choices` if they were shrunk by choices, without evaluating the property.
+ */
+struct StoredFailure
+{
+    uint64_t seed = 0;
+    uint64_t runIndex = 0;
+    vector<uint64_t> runChoices;
+    vector<ShrinkStep> shrinkPath;
+    bool byChoices = false;
+    vector<uint64_t> choices;
+    string args;  // shrunk arguments as printed, kept for reference only
+};
+
+/**
+ * @brief On-disk store of the failures of properties, keyed by property name
+ * @details The failures of a property are kept in a text file named after the property in the database directory, so
+ * they are replayed first on the next run (see `Property::setName`). The directory is created on the first save.
+ */
+class PROPTEST_API FailureDatabase {
+public:
+    explicit FailureDatabase(const string& _directory);
+
+    // failures stored for the property, empty if there are none or the file can't be read. Invalid records are
+    // reported and skipped
+    vector<StoredFailure> load(const string& name) const;
+
+    // replaces the failures stored for the property, removing its file if there are none. Returns false if the file
+    // can't be written, reporting why
+    bool save(const string& name, const vector<StoredFailure>& failures) const;
+
+    string getPath(const string& name) const;
+
+private:
+    string directory;
+};
+
+namespace util {
+
+// database directory given by the PROPTEST_DATABASE environment variable, empty if not set
+PROPTEST_API string getDefaultDatabaseDir();
+
+}  // namespace util
+
+}  // namespace proptest
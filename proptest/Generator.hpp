@@ -8,6 +8,8 @@
 #include "assert.hpp"
 #include "combinator/transform.hpp"
 #include "combinator/filter.hpp"
+#include "combinator/memoize.hpp"
+#include "combinator/profile.hpp"
 #include "combinator/dependency.hpp"
 #include "combinator/chain.hpp"
 #include "combinator/derive.hpp"
@@ -93,6 +95,29 @@ struct Generator : public GenBase<T>
         return proptest::filter<T>(util::GeneratorFunctor<T>(thisPtr), criteria);
     }
 
+    /**
+     * @brief Higher-order function that returns an altered Generator whose generated values memoize their shrinks
+     *
+     * @return Generator<T> New Generator for type `T` evaluating each node of the shrink tree only once
+     */
+    Generator<T> memoize()
+    {
+        auto thisPtr = clone();
+        return proptest::memoize<T>(util::GeneratorFunctor<T>(thisPtr));
+    }
+
+    /**
+     * @brief Higher-order function that returns a Generator recording its cost under `name` in the generation profile
+     *
+     * @param name Name of the node in the profile (see `Property::setGenProfile()`)
+     * @return Generator<T> New Generator for type `T` generating the same values
+     */
+    Generator<T> profile(const string& name)
+    {
+        auto thisPtr = clone();
+        return proptest::profile<T>(name, util::GeneratorFunctor<T>(thisPtr));
+    }
+
     /**
      * @brief Higher-order function that lets you produce a pair of dependent generators, by taking a generated result
      * from this Generator
@@ -2,6 +2,7 @@
 #include "assert.hpp"
 #include "util/tuple.hpp"
 #include "util/std.hpp"
+#include "util/hash.hpp"
 
 namespace proptest {
 
@@ -20,15 +21,259 @@ uint64_t getGlobalSeed()
 
 }  // namespace utilr
 
-PropertyContext* PropertyBase::context = nullptr;
+namespace {
+thread_local PropertyContext* context = nullptr;
+}  // namespace
+
+ShrinkProgress::ShrinkProgress(uint32_t _maxSteps, uint32_t _maxEvaluations, uint32_t _maxDurationMs)
+    : maxSteps(_maxSteps),
+      maxEvaluations(_maxEvaluations),
+      maxDurationMs(_maxDurationMs),
+      numSteps(0),
+      numEvaluations(0),
+      numCacheHits(0),
+      startedTime(steady_clock::now()),
+      stopReason(nullptr)
+{
+}
+
+bool ShrinkProgress::canEvaluate()
+{
+    if (stopReason)
+        return false;
+    if (maxSteps != 0 && numSteps >= maxSteps)
+        stopReason = "step";
+    else if (maxEvaluations != 0 && numEvaluations >= maxEvaluations)
+        stopReason = "evaluation";
+    else if (maxDurationMs != 0 && elapsedMs() >= maxDurationMs)
+        stopReason = "duration";
+    return stopReason == nullptr;
+}
+
+size_t ShrinkProgress::numEvaluable(size_t n) const
+{
+    if (maxEvaluations != 0 && maxEvaluations - numEvaluations < n)
+        return static_cast<size_t>(maxEvaluations - numEvaluations);
+    return n;
+}
+
+uint64_t ShrinkProgress::elapsedMs() const
+{
+    return static_cast<uint64_t>(duration_cast<util::milliseconds>(steady_clock::now() - startedTime).count());
+}
+
+void ShrinkProgress::print(ostream& os) const
+{
+    if (stopReason)
+        os << "  shrinking stopped at the " << stopReason << " limit";
+    else
+        os << "  shrinking done";
+    os << ": " << numSteps << " steps accepted, " << numEvaluations << " evaluations";
+    if (numCacheHits > 0) {
+        os << ", " << numCacheHits << " cache hits (" << (numCacheHits * 100 / (numCacheHits + numEvaluations))
+           << "%)";
+    }
+    os << ", " << elapsedMs() << "ms" << endl;
+}
+
+ShrinkCache::ShrinkCache(size_t _capacity) : capacity(_capacity), next(0) {}
+
+bool ShrinkCache::contains(size_t hash) const
+{
+    return hashes.find(hash) != hashes.end();
+}
+
+void ShrinkCache::insert(size_t hash)
+{
+    if (capacity == 0 || !hashes.insert(hash).second)
+        return;
+    if (order.size() < capacity) {
+        order.push_back(hash);
+    } else {
+        hashes.erase(order[next]);
+        order[next] = hash;
+        next = (next + 1) % capacity;
+    }
+}
+
+ShrinkSchedule::ShrinkSchedule(size_t numArgs) : numEvaluations(numArgs, 0), numNanos(numArgs, 0) {}
+
+vector<size_t> ShrinkSchedule::order() const
+{
+    vector<uint64_t> costs(numEvaluations.size(), 0);
+    for (size_t i = 0; i < costs.size(); i++)
+        costs[i] = numEvaluations[i] == 0 ? 0 : numNanos[i] / numEvaluations[i];
+    vector<size_t> indices(costs.size());
+    for (size_t i = 0; i < indices.size(); i++)
+        indices[i] = i;
+    std::stable_sort(indices.begin(), indices.end(), [&costs](size_t a, size_t b) { return costs[a] < costs[b]; });
+    return indices;
+}
+
+void ShrinkSchedule::record(size_t arg, uint64_t evaluations, uint64_t nanos)
+{
+    numEvaluations[arg] += evaluations;
+    numNanos[arg] += nanos;
+}
+
+namespace util {
+
+namespace {
+
+// true if a is shorter than b, or as long and lexicographically smaller
+bool isSimplerChoices(const vector<uint64_t>& a, const vector<uint64_t>& b)
+{
+    if (a.size() != b.size())
+        return a.size() < b.size();
+    return a < b;
+}
+
+}  // namespace
+
+void shrinkChoices(vector<uint64_t>& choices, const function<bool(const vector<uint64_t>&, size_t&)>& fails,
+                   const function<void(const vector<uint64_t>&)>& onAccept, ShrinkProgress& progress,
+                   ShrinkCache& cache)
+{
+    // returns true if the candidate fails and is taken as the new buffer
+    auto tryCandidate = [&](const vector<uint64_t>& candidate) {
+        if (!isSimplerChoices(candidate, choices) || !progress.canEvaluate())
+            return false;
+        size_t hash = Hash<vector<uint64_t>>()(candidate);
+        if (cache.contains(hash)) {
+            progress.cacheHit();
+            return false;
+        }
+        progress.evaluated(1);
+        size_t numUsed = candidate.size();
+        if (!fails(candidate, numUsed)) {
+            cache.insert(hash);
+            return false;
+        }
+        // choices left unused are dropped
+        choices.assign(candidate.begin(), candidate.begin() + (numUsed < candidate.size() ? numUsed : candidate.size()));
+        progress.accepted();
+        onAccept(choices);
+        return true;
+    };
+
+    const size_t runLengths[] = {8, 4, 2, 1};
+    bool improved = true;
+    while (improved && !progress.isStopped()) {
+        improved = false;
+
+        // delete runs of choices, from the back
+        for (size_t length : runLengths) {
+            for (size_t end = choices.size(); end >= length && !progress.isStopped();) {
+                vector<uint64_t> candidate(choices.begin(), choices.begin() + (end - length));
+                candidate.insert(candidate.end(), choices.begin() + end, choices.end());
+                if (tryCandidate(candidate)) {
+                    improved = true;
+                    end = end - length < choices.size() ? end - length : choices.size();
+                } else {
+                    end--;
+                }
+            }
+        }
+
+        // zero runs of choices
+        for (size_t length : runLengths) {
+            for (size_t begin = 0; begin + length <= choices.size() && !progress.isStopped(); begin++) {
+                if (std::all_of(choices.begin() + begin, choices.begin() + begin + length,
+                                [](uint64_t choice) { return choice == 0; }))
+                    continue;
+                vector<uint64_t> candidate = choices;
+                std::fill(candidate.begin() + begin, candidate.begin() + begin + length, 0);
+                if (tryCandidate(candidate))
+                    improved = true;
+            }
+        }
+
+        // minimize each choice by binary search between 0 (passing) and its value (failing)
+        for (size_t i = 0; i < choices.size() && !progress.isStopped(); i++) {
+            uint64_t lo = 0, hi = choices[i];
+            while (hi - lo > 1 && i < choices.size() && !progress.isStopped()) {
+                uint64_t mid = lo + (hi - lo) / 2;
+                vector<uint64_t> candidate = choices;
+                candidate[i] = mid;
+                if (tryCandidate(candidate)) {
+                    improved = true;
+                    hi = mid;
+                } else {
+                    lo = mid;
+                }
+            }
+        }
+
+        // lower a choice by one while deleting a run after it, as the size of a list with one of its elements
+        for (size_t i = 0; i < choices.size() && !improved && !progress.isStopped(); i++) {
+            if (choices[i] == 0)
+                continue;
+            for (size_t length : runLengths) {
+                for (size_t begin = i + 1; begin + length <= choices.size() && !improved && !progress.isStopped();
+                     begin++) {
+                    vector<uint64_t> candidate = choices;
+                    candidate[i]--;
+                    candidate.erase(candidate.begin() + begin, candidate.begin() + begin + length);
+                    if (tryCandidate(candidate))
+                        improved = true;
+                }
+            }
+        }
+    }
+}
+
+}  // namespace util
+
 uint32_t PropertyBase::defaultNumRuns = 1000;
 uint32_t PropertyBase::defaultMaxDurationMs = 0;
+uint32_t PropertyBase::defaultNumThreads = 1;
+uint32_t PropertyBase::defaultShrinkCacheSize = 16384;
+
+mutex PropertyBase::suiteBudgetMutex;
+steady_clock::time_point PropertyBase::suiteBudgetEnd;
+uint32_t PropertyBase::suiteNumPropertiesLeft = 0;
+
+void PropertyBase::setDefaultNumRuns(uint32_t runs)
+{
+    defaultNumRuns = runs;
+}
+
+void PropertyBase::setDefaultNumThreads(uint32_t threads)
+{
+    defaultNumThreads = threads;
+}
+
+void PropertyBase::setSuiteTimeBudget(uint32_t totalMs, uint32_t numProperties)
+{
+    lock_guard<mutex> lock(suiteBudgetMutex);
+    suiteBudgetEnd = steady_clock::now() + util::milliseconds(totalMs);
+    suiteNumPropertiesLeft = numProperties;
+}
+
+uint32_t PropertyBase::takeTimeBudgetMs()
+{
+    if (timeBudgetMs != 0)
+        return timeBudgetMs;
+    lock_guard<mutex> lock(suiteBudgetMutex);
+    if (suiteNumPropertiesLeft == 0)
+        return 0;
+    int64_t leftMs = duration_cast<util::milliseconds>(suiteBudgetEnd - steady_clock::now()).count();
+    uint32_t share = leftMs > 0 ? static_cast<uint32_t>(leftMs / suiteNumPropertiesLeft) : 0;
+    suiteNumPropertiesLeft--;
+    // a property past the end of the budget still makes a run
+    return share > 0 ? share : 1;
+}
 
 void PropertyBase::setContext(PropertyContext* ctx)
 {
     context = ctx;
 }
 
+PropertyContext* PropertyBase::getContext()
+{
+    return context;
+}
+
 void PropertyBase::tag(const char* file, int lineno, string key, string value)
 {
     if (!context)
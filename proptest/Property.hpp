@@ -8,6 +8,10 @@
 #include "util/invokeWithGenTuple.hpp"
 #include "util/invokeWithArgs.hpp"
 #include "util/createGenTuple.hpp"
+#include "util/parallel.hpp"
+#include "util/arena.hpp"
+#include "util/hash.hpp"
+#include "util/coverage.hpp"
 #include "generator/util.hpp"
 #include "PropertyContext.hpp"
 #include "PropertyBase.hpp"
@@ -103,6 +107,41 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Replays a single run, regenerating its inputs directly from the seed and the run index
+     * @details Replays the run reported by a failed test (`failed at run index N`) without going through the
+     * preceding runs. The inputs are shrunk if the run fails again. Replaying stays in effect until
+     * `clearReplay()` is called.
+     *
+     * Not supported with the `MT19937_64` engine, whose runs share a single random stream.
+     *
+     * @param s Seed of the failed test
+     * @param runIndex Index of the run to replay
+     * @return Property& `Property` object itself for chaining
+     * @throws invalid_argument if the default engine is `MT19937_64`
+     */
+    Property& setReplay(uint64_t s, uint64_t runIndex)
+    {
+        if (Random::getDefaultEngineType() == Random::EngineType::MT19937_64)
+            throw invalid_argument("replaying a single run is not supported with MT19937_64 engine");
+        seed = s;
+        replay = true;
+        replayIndex = runIndex;
+        return *this;
+    }
+
+    /**
+     * @brief Goes back to running all the runs after `setReplay()`
+     *
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& clearReplay()
+    {
+        replay = false;
+        replayIndex = 0;
+        return *this;
+    }
+
     /**
      * @brief Sets the number of runs
      *
@@ -151,6 +190,295 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Sets the maximum number of discards (see `PROP_DISCARD()`) across the runs
+     * @details Inputs are generated again as long as a run is discarded. Once the discards exceed the maximum, the
+     * runs are given up and the test fails, telling where the discards were made.
+     *
+     * @param discards Maximum number of discards. Default is 0 meaning there is no limit other than
+     * `setMaxDiscardRatio()`
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setMaxDiscards(uint32_t discards)
+    {
+        maxDiscards = discards;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the maximum number of discards (see `PROP_DISCARD()`) per run
+     * @details The runs are given up and the test fails once the discards exceed `ratio` times the number of runs (or
+     * of the runs made so far, if more, as in a time budget), so that a precondition rarely met doesn't keep the test
+     * generating inputs indefinitely.
+     *
+     * @param ratio Maximum number of discards per run. Default is 10. 0 means there is no limit other than
+     * `setMaxDiscards()`
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setMaxDiscardRatio(double ratio)
+    {
+        if (ratio < 0.0)
+            throw invalid_argument("discard ratio must not be negative");
+        maxDiscardRatio = ratio;
+        return *this;
+    }
+
+    /**
+     * @brief Sets a time budget to fill with runs, instead of a number of runs
+     * @details The cost of a run is measured on the fly, and runs go on as long as another run of the average cost
+     * fits in the budget. The number of runs set is ignored. Shrinking is not counted in the budget. See
+     * `PropertyBase::setSuiteTimeBudget()` to split a budget across properties.
+     *
+     * @param budgetMs Time to fill with runs, in milliseconds. Default is 0 meaning the number of runs is used
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setTimeBudgetMs(uint32_t budgetMs)
+    {
+        timeBudgetMs = budgetMs;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the number of threads the runs are split across.
+     * @details With more than one thread, each run is generated from its own random stream derived from the seed and
+     * the run index, and the property function, generators and startup/cleanup functions are called concurrently.
+     * They should be thread-safe in this case.
+     *
+     * @param threads Number of worker threads. Default is 1 meaning the runs are executed on the calling thread
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setNumThreads(uint32_t threads)
+    {
+        numThreads = threads;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the number of shrink candidates evaluated concurrently while shrinking.
+     * @details Candidates are taken in batches from the shrink stream and tested on a pool of `threads` workers,
+     * started once per shrinking. The first failing candidate in stream order is accepted, so the result is the same
+     * as with sequential shrinking. Useful for slow properties, given the property function and startup/cleanup
+     * functions are thread-safe.
+     *
+     * @param threads Number of candidates tested at once. Default is 1 meaning candidates are tested one by one
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setNumShrinkThreads(uint32_t threads)
+    {
+        numShrinkThreads = threads;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the maximum number of shrinking steps, i.e. simpler failing arguments accepted while shrinking
+     * @details When a shrink limit is reached, shrinking stops and reports the simplest failing arguments found so
+     * far.
+     *
+     * @param steps Maximum number of steps. Default is 0 meaning there is no limit
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setMaxShrinkSteps(uint32_t steps)
+    {
+        maxShrinkSteps = steps;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the maximum number of shrink candidates tested while shrinking
+     *
+     * @param evaluations Maximum number of calls to the property function. Default is 0 meaning there is no limit
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setMaxShrinkEvaluations(uint32_t evaluations)
+    {
+        maxShrinkEvaluations = evaluations;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the maximum time to spend in shrinking. `setMaxDurationMs()` doesn't include shrinking
+     *
+     * @param durationMs Maximum duration of shrinking in milliseconds. Default is 0 meaning there is no limit
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setMaxShrinkDurationMs(uint32_t durationMs)
+    {
+        maxShrinkDurationMs = durationMs;
+        return *this;
+    }
+
+    /**
+     * @brief Sets whether to shrink the arguments in rounds until none of them can be shrunk further
+     * @details By default each argument is shrunk once, in order, so an argument can remain shrinkable after the ones
+     * following it have been simplified. In fixpoint mode the arguments are shrunk again in rounds until a round
+     * finds no simpler failing arguments. An argument shrunk again also retries the candidates it rejected before the
+     * other arguments were simplified. Within a round, the arguments whose candidates were measured cheaper to
+     * evaluate are shrunk first.
+     *
+     * @param enable Whether to shrink to a fixpoint. Default is false
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setShrinkToFixpoint(bool enable)
+    {
+        shrinkToFixpoint = enable;
+        return *this;
+    }
+
+    /**
+     * @brief Sets whether to shrink by the choices the failed inputs were generated from
+     * @details Every value drawn while regenerating the failed inputs is recorded as a choice (see
+     * `util::ChoiceBuffer`), and shrinking deletes, zeroes and minimizes the choices, regenerating the inputs from the
+     * choices for each candidate. Inputs are generated as plain values without building their shrinks, so any
+     * composition of generators is shrunk the same way, including the ones made with `flatMap` or `dependency`.
+     *
+     * @param enable Whether to shrink by choices. Default is false meaning the shrinks of the inputs are used
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setChoiceShrinking(bool enable)
+    {
+        choiceShrinking = enable;
+        return *this;
+    }
+
+    /**
+     * @brief Sets whether to guide generation by the edge coverage of the code under test
+     * @details Needs the code under test compiled by Clang with `-fsanitize-coverage=inline-8bit-counters` or
+     * `-fsanitize-coverage=trace-pc-guard`, whose counters are read after each run (see `util::Coverage`). The
+     * choices of the runs hitting new edges are kept in a corpus, and half of the later runs are generated from
+     * mutated copies of them, so that inputs reaching deeper into parsers or decoders are found with fewer runs.
+     * Failures of mutated runs can't be replayed with `setReplay()`, but are stored with their choices in the
+     * failure database. Runs are generated blindly if there are no counters, with more than one thread, or with
+     * the `MT19937_64` engine.
+     *
+     * @param enable Whether to guide generation by coverage. Default is false
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setCoverageGuided(bool enable)
+    {
+        coverageGuided = enable;
+        return *this;
+    }
+
+    /**
+     * @brief Sets whether to time the phases of the runs and of shrinking
+     * @details Generation of the inputs, the startup function, the property function and the cleanup function are
+     * timed in each run, as well as each candidate evaluated while shrinking. Their latency (p50 / p99 / max), the
+     * runs per second and the shrink evaluations are printed after the summary, followed by the same as a JSON
+     * object on a line starting with `stats json: `. Nothing is timed if disabled.
+     *
+     * @param enable Whether to collect stats. Default is false
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setStats(bool enable)
+    {
+        collectStats = enable;
+        return *this;
+    }
+
+    /**
+     * @brief Stats of the last `forAll()` run with stats enabled (see `setStats()`), empty if none
+     */
+    RunStats getStats() const { return stats ? *stats : RunStats(); }
+
+    /**
+     * @brief Sets whether to profile the generators of the arguments
+     * @details The cost of generating each argument is recorded as a tree of the generators it is composed of, each
+     * combinator (`filter`, `oneOf`, `map`, `flatMap`, `dependency`, `chain`) and each generator named with
+     * `profile()` being a node. The calls, wall time, allocations (see `PROPTEST_COUNT_ALLOCATIONS`) and rejections
+     * of each node are printed after the summary. Generators are not profiled while shrinking.
+     *
+     * @param enable Whether to profile generation. Default is false
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setGenProfile(bool enable)
+    {
+        genProfiling = enable;
+        return *this;
+    }
+
+    /**
+     * @brief Generation profile of the last `forAll()` run with profiling enabled (see `setGenProfile()`), nullptr if
+     * none
+     */
+    shared_ptr<const util::GenProfile> getGenProfile() const { return genProfile; }
+
+    /**
+     * @brief Sets the number of passing shrink candidates remembered while shrinking
+     * @details Shrinkers often produce the same candidate more than once. A candidate whose arguments hash the same as
+     * one already found passing is skipped instead of running the property again. Arguments are hashed with `Hash<T>`.
+     * If any of the argument types has none, candidates are always tested.
+     *
+     * @param size Maximum number of candidates remembered. Default is 16384. 0 disables the cache
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setShrinkCacheSize(uint32_t size)
+    {
+        shrinkCacheSize = size;
+        return *this;
+    }
+
+    /**
+     * @brief Sets whether the inputs of each run are generated as plain values
+     * @details Passing runs never look at the shrinks of their inputs, so by default the generators skip building
+     * them. When a run fails, its inputs are regenerated from the same random state with their shrinks before
+     * shrinking. This relies on generators producing the same values from the same random state, as shrinking
+     * always has.
+     *
+     * @param enable Whether to generate values only. Default is true
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setValueOnlyGeneration(bool enable)
+    {
+        valueOnlyGeneration = enable;
+        return *this;
+    }
+
+    /**
+     * @brief Allocates the shrinkables and streams built during each run from a per-thread arena
+     * @details The arena is a monotonic buffer: the nodes of a run and of its shrinking are taken from it by bumping
+     * a pointer, and the memory is given back all at once when the run passes or shrinking finishes. Memory freed
+     * in the middle of shrinking is only reused after that, so peak memory of a long shrinking session may grow. The
+     * arena is not reset while any of its nodes is still referenced, e.g. by a value kept by the property function.
+     *
+     * @param enable Whether to use the arena. Default is false meaning the nodes are allocated on the global heap
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setUseArena(bool enable)
+    {
+        useArena = enable;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the name of the property, under which its failures are kept in the failure database
+     * @details If the property fails while a database directory is set (see `setDatabase()`), the seed and the run
+     * index of the failure are stored with the path from the failed arguments to the shrunk ones. Each `forAll()`
+     * replays the stored failures before new runs: the shrunk arguments are regenerated by following the path, and
+     * reported without shrinking again if they still fail. Otherwise the failed run is replayed and shrunk. Failures
+     * that pass are removed from the database.
+     *
+     * @param _name Name of the property, unique in the database. Failures are not stored if empty
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setName(const string& _name)
+    {
+        name = _name;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the directory of the failure database (see `setName()`)
+     *
+     * @param directory Directory of the database, created when a failure is stored. Default is the value of the
+     * `PROPTEST_DATABASE` environment variable, and failures are not stored if empty
+     * @return Property& `Property` object itself for chaining
+     */
+    Property& setDatabase(const string& directory)
+    {
+        databaseDir = directory;
+        return *this;
+    }
+
     /**
      * @brief Executes randomized tests for given property. If explicit generator arguments are omitted, utilizes
      * default generators (a.k.a. Arbitraries) instead
@@ -188,79 +516,426 @@ public:
         return example(valueTup);
     }
 
+    /**
+     * @brief Runs the property once with inputs generated from the bytes given by a fuzzer
+     * @details The bytes are read as the choices of the values drawn by the generators (see
+     * `util::choicesFromBytes()`), so a fuzzer mutating the bytes mutates the generated inputs. Values drawn past the
+     * end of the bytes are taken from a fixed random stream. Nothing is printed unless the property fails, in which
+     * case the inputs are shrunk as in `forAll()`. Use `PROPTEST_FUZZ_TARGET` to define an entry point for libFuzzer
+     * or AFL++.
+     *
+     * @param data Input of the fuzzer
+     * @param size Size of the input in bytes
+     * @param gens Variadic list of optional explicit generators (in same order as in definition of property arguments)
+     * @return true if the property passes or the inputs are discarded
+     * @return false if the property fails
+     */
+    template <typename... ExplicitGens>
+    bool fuzz(const uint8_t* data, size_t size, ExplicitGens&&... gens)
+    {
+        auto curGenTup = util::overrideTuple(getGenTup(), gens...);
+        auto buffer = util::make_shared<util::ChoiceBuffer>();
+        buffer->choices = util::choicesFromBytes(data, size);
+        // the bytes map onto the ranges evenly, and are replaced with the choices taken, so that the failed inputs
+        // can be regenerated from the buffer while shrinking
+        buffer->wrapping = true;
+        Random rand = Random::fromChoices(buffer);
+        buffer->recording = true;
+        Random savedRand(rand);
+        PropertyContext ctx;
+        util::ArenaScope arenaScope(useArena);
+        stringstream failureStr;
+        if (runOnce(rand, curGenTup, ctx, failureStr) != RunResult::FAIL)
+            return true;
+
+        cerr << "Falsifiable, by fuzzer input of " << size << " bytes" << failureStr.str();
+        // every choice taken has been recorded, so the run is regenerated from them whatever the seed
+        vector<uint64_t> runChoices = buffer->choices;
+        storeFailure(seed, 0, shrink(savedRand, util::forward<decltype(curGenTup)>(curGenTup)), runChoices);
+        return false;
+    }
+
 private:
 
+    enum class RunResult { PASS, DISCARD, FAIL };
+
+    /**
+     * @brief Generates inputs and runs the property function once, describing the failure in `failureStr` if any
+     */
+    RunResult runOnce(Random& rand, GenTuple& curGenTup, PropertyContext& ctx, stringstream& failureStr,
+                      RunStats* runStats = nullptr, util::GenProfile* runGenProfile = nullptr)
+    {
+        try {
+            if (onStartupPtr) {
+                util::PhaseTimer timer(runStats ? &runStats->startup : nullptr);
+                (*onStartupPtr)();
+            }
+            bool result;
+            {
+                RunTimer timer(runStats);
+                result = util::invokeWithGenTuple(rand, getFunc(), curGenTup, valueOnlyGeneration,
+                                                  timer.generationNanos(), runGenProfile);
+            }
+            if (onCleanupPtr) {
+                util::PhaseTimer timer(runStats ? &runStats->cleanup : nullptr);
+                (*onCleanupPtr)();
+            }
+            stringstream failures = ctx.flushFailures();
+            // failed expectations
+            if (failures.rdbuf()->in_avail()) {
+                failureStr << ": " << failures.str();
+                return RunResult::FAIL;
+            } else if (!result) {
+                failureStr << endl;
+                return RunResult::FAIL;
+            }
+            return RunResult::PASS;
+        } catch (const Success&) {
+            return RunResult::PASS;
+        } catch (const Discard& e) {
+            // discard combination, counting the discards of each site
+            ctx.discard(e.filename, e.lineno);
+            if (runStats)
+                runStats->discardSites.add(e.filename, e.lineno);
+            return RunResult::DISCARD;
+        } catch (const AssertFailed& e) {
+            failureStr << ": " << e.what() << " (" << e.filename << ":" << e.lineno << ")" << endl;
+        } catch (const PropertyFailedBase& e) {
+            failureStr << ": " << e.what() << " (" << e.filename << ":" << e.lineno << ")" << endl;
+        } catch (const exception& e) {
+            failureStr << " - unhandled exception thrown: " << e.what() << endl;
+        }
+        return RunResult::FAIL;
+    }
+
+    /**
+     * @brief Runs once, generating new inputs as long as they are discarded. `savedRand` is left at the state the
+     * last inputs were generated from. Returns `RunResult::DISCARD` if the discards exceed `discardLimit`
+     */
+    RunResult runUntilDecided(Random& rand, Random& savedRand, GenTuple& curGenTup, PropertyContext& ctx,
+                              stringstream& failureStr, RunStats* runStats = nullptr,
+                              util::GenProfile* runGenProfile = nullptr, DiscardLimit* discardLimit = nullptr)
+    {
+        RunResult result;
+        do {
+            savedRand = rand;
+            result = runOnce(rand, curGenTup, ctx, failureStr, runStats, runGenProfile);
+            if (result == RunResult::DISCARD) {
+                if (runStats)
+                    runStats->numDiscards++;
+                if (discardLimit && !discardLimit->discarded())
+                    return result;
+            }
+        } while (result == RunResult::DISCARD);
+        if (discardLimit)
+            discardLimit->decided();
+        if (runStats)
+            runStats->numRuns++;
+        return result;
+    }
+
+    // stats to record into, nullptr if not collecting
+    RunStats* activeStats() { return collectStats ? stats.get() : nullptr; }
+
+    // generation profile to record into, nullptr if not profiling
+    util::GenProfile* activeGenProfile() { return genProfiling ? genProfile.get() : nullptr; }
+
+    util::Histogram* shrinkEvaluationHistogram() { return activeStats() ? &stats->shrinkEvaluation : nullptr; }
+
+    void recordShrinkStats(const ShrinkProgress& progress)
+    {
+        if (!activeStats())
+            return;
+        stats->numShrinkEvaluations += progress.numEvaluations;
+        stats->numShrinkSteps += progress.numSteps;
+        stats->shrinkNanos +=
+            static_cast<uint64_t>(duration_cast<util::nanoseconds>(steady_clock::now() - progress.startedTime).count());
+    }
+
+    void printReplayHint(size_t runIndex)
+    {
+        cerr << "  failed at run index " << runIndex << ", to replay: setReplay(" << seed << ", " << runIndex << ")"
+             << endl;
+    }
+
     bool runForAll(GenTuple&& curGenTup)
     {
+        if (!collectStats && !genProfiling)
+            return runAll(util::forward<GenTuple>(curGenTup));
+
+        if (collectStats)
+            stats = util::make_shared<RunStats>();
+        if (genProfiling)
+            genProfile = util::make_shared<util::GenProfile>();
+        auto startTime = steady_clock::now();
+        bool result = runAll(util::forward<GenTuple>(curGenTup));
+        if (collectStats) {
+            auto nanos =
+                static_cast<uint64_t>(duration_cast<util::nanoseconds>(steady_clock::now() - startTime).count());
+            stats->runNanos = nanos > stats->shrinkNanos ? nanos - stats->shrinkNanos : 0;
+            stats->print(cout);
+            cout << "stats json: ";
+            stats->printJson(cout, name);
+            cout << endl;
+        }
+        if (genProfiling)
+            genProfile->print(cout);
+        return result;
+    }
+
+    bool runAll(GenTuple&& curGenTup)
+    {
+        if (replay)
+            return runReplay(util::forward<GenTuple>(curGenTup));
+        if (hasDatabase() && !replayStoredFailures(curGenTup))
+            return false;
+        if (coverageGuided && numThreads > 1)
+            cout << "coverage guidance is not supported with more than one thread, generating blindly" << endl;
+        if (numThreads > 1)
+            return runForAllParallel(util::forward<GenTuple>(curGenTup));
+
+        // each run draws from its own stream keyed by the seed and the run index, except in compatibility mode where
+        // a single stream continues across the runs as in former versions
+        bool sharedStream = Random::getDefaultEngineType() == Random::EngineType::MT19937_64;
+        bool guided = coverageGuided && canGuideByCoverage(sharedStream);
         Random rand(seed);
         Random savedRand(seed);
         cout << "random seed: " << seed << endl;
         PropertyContext ctx;
         auto startedTime = steady_clock::now();
+        util::Coverage coverage;
+        util::CoverageCorpus corpus;
+        Random mutationRand(seed);
+        uint32_t budgetMs = takeTimeBudgetMs();
+        size_t runLimit = budgetMs != 0 ? SIZE_MAX : numRuns;
+        DiscardLimit discardLimit(maxDiscards, maxDiscardRatio, numRuns);
 
         size_t i = 0;
-        try {
-            for (; i < numRuns; i++) {
-                if(maxDurationMs != 0) {
+        for (; i < runLimit; i++) {
+            if (budgetMs != 0 && i > 0 && !fitsInBudget(startedTime, budgetMs, i))
+                break;
+            if(maxDurationMs != 0) {
+                auto currentTime = steady_clock::now();
+                if(duration_cast<util::milliseconds>(currentTime - startedTime).count() > maxDurationMs)
+                {
+                    cout << "Timed out after " << duration_cast<util::milliseconds>(currentTime - startedTime).count() << "ms , passed " << i << " tests" << endl;
+                    ctx.printSummary();
+                    return true;
+                }
+            }
+            if (!sharedStream)
+                rand = Random::forRun(seed, i);
+            shared_ptr<util::ChoiceBuffer> choices;
+            bool mutated = false;
+            if (guided) {
+                // half of the runs start from mutated choices of a run that found new coverage
+                choices = util::make_shared<util::ChoiceBuffer>();
+                mutated = !corpus.empty() && mutationRand.getRandomBool();
+                if (mutated) {
+                    choices->choices = corpus.mutate(mutationRand);
+                    rand.replayChoices(choices);
+                } else {
+                    rand.recordChoices(choices);
+                }
+                util::Coverage::reset();
+            }
+            util::ArenaScope arenaScope(useArena);
+            stringstream failureStr;
+            RunResult result = runUntilDecided(rand, savedRand, curGenTup, ctx, failureStr, activeStats(),
+                                               activeGenProfile(), &discardLimit);
+
+            if (result == RunResult::DISCARD) {
+                discardLimit.printGaveUp(cerr);
+                ctx.printSummary();
+                return false;
+            }
+            if (result == RunResult::FAIL) {
+                cerr << "Falsifiable, after " << (i + 1) << " tests" << failureStr.str();
+                if (mutated)
+                    cerr << "  failed at run index " << i << ", generated from mutated choices of former runs" << endl;
+                else if (!sharedStream)
+                    printReplayHint(i);
+                // shrink
+                StoredFailure failure = shrink(savedRand, util::forward<GenTuple>(curGenTup));
+                // a run can't be regenerated by its index from a stream continued across the runs
+                if (!sharedStream)
+                    storeFailure(seed, i, util::move(failure), mutated ? choices->choices : vector<uint64_t>());
+                return false;
+            }
+            if (guided && coverage.update() > 0) {
+                choices->choices.resize(rand.getNumChoicesUsed());
+                corpus.add(util::move(choices->choices));
+            }
+        }
+
+        if (budgetMs != 0)
+            cout << "OK, passed " << i << " tests in time budget of " << budgetMs << "ms" << endl;
+        else
+            cout << "OK, passed " << numRuns << " tests" << endl;
+        if (guided)
+            cout << "  coverage: " << coverage.numFeatures() << " features, " << corpus.size() << " inputs kept" << endl;
+        ctx.printSummary();
+        return true;
+    }
+
+    // returns true if another run of the average cost of the runs so far fits in the budget
+    static bool fitsInBudget(steady_clock::time_point startedTime, uint32_t budgetMs, size_t numDone)
+    {
+        auto elapsed = static_cast<uint64_t>(duration_cast<util::nanoseconds>(steady_clock::now() - startedTime).count());
+        return elapsed + elapsed / numDone <= static_cast<uint64_t>(budgetMs) * 1000000;
+    }
+
+    // returns true if runs can be guided by coverage, otherwise tells why
+    bool canGuideByCoverage(bool sharedStream)
+    {
+        if (sharedStream) {
+            cout << "coverage guidance is not supported with MT19937_64 engine, generating blindly" << endl;
+            return false;
+        }
+        if (!util::Coverage::isAvailable()) {
+            cout << "no coverage counters found, compile with -fsanitize-coverage=inline-8bit-counters for coverage "
+                    "guidance. generating blindly"
+                 << endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool runReplay(GenTuple&& curGenTup)
+    {
+        // the engine may have been changed since setReplay()
+        if (Random::getDefaultEngineType() == Random::EngineType::MT19937_64)
+            throw invalid_argument("replaying a single run is not supported with MT19937_64 engine");
+        cout << "random seed: " << seed << ", replaying run index " << replayIndex << endl;
+        PropertyContext ctx;
+        Random rand = Random::forRun(seed, replayIndex);
+        Random savedRand(rand);
+        util::ArenaScope arenaScope(useArena);
+        stringstream failureStr;
+        DiscardLimit discardLimit(maxDiscards, maxDiscardRatio, 1);
+        RunResult result = runUntilDecided(rand, savedRand, curGenTup, ctx, failureStr, activeStats(),
+                                           activeGenProfile(), &discardLimit);
+
+        if (result == RunResult::DISCARD) {
+            discardLimit.printGaveUp(cerr);
+            ctx.printSummary();
+            return false;
+        }
+        if (result == RunResult::FAIL) {
+            cerr << "Falsifiable, at run index " << replayIndex << failureStr.str();
+            // shrink
+            storeFailure(seed, replayIndex, shrink(savedRand, util::forward<GenTuple>(curGenTup)));
+            return false;
+        }
+
+        cout << "OK, passed run index " << replayIndex << endl;
+        ctx.printSummary();
+        return true;
+    }
+
+    /**
+     * @brief Splits the runs across `numThreads` workers.
+     * @details Each run draws from its own random stream keyed by `seed` and the run index, so the generated
+     * inputs don't depend on the number of threads or the scheduling. Runs are claimed in index order and claiming
+     * stops once a failure is found, so every run preceding the reported failure has been completed.
+     */
+    bool runForAllParallel(GenTuple&& curGenTup)
+    {
+        cout << "random seed: " << seed << endl;
+        PropertyContext ctx;
+        auto startedTime = steady_clock::now();
+
+        uint32_t budgetMs = takeTimeBudgetMs();
+        size_t runLimit = budgetMs != 0 ? SIZE_MAX : numRuns;
+
+        mutex resultMutex;
+        atomic<size_t> nextIndex{0};
+        atomic<size_t> numPassed{0};
+        atomic<size_t> failedIndex{runLimit};
+        atomic<bool> timedOut{false};
+        DiscardLimit discardLimit(maxDiscards, maxDiscardRatio, numRuns);
+        string failureMessage;
+        Random failedRand(seed);
+
+        util::runParallel(numThreads, [&](uint32_t) {
+            PropertyContext workerCtx;
+            RunStats workerStats;
+            RunStats* workerStatsPtr = activeStats() ? &workerStats : nullptr;
+            util::GenProfile workerGenProfile;
+            util::GenProfile* workerGenProfilePtr = activeGenProfile() ? &workerGenProfile : nullptr;
+            while (true) {
+                size_t i = nextIndex++;
+                if (i >= runLimit || i >= failedIndex || discardLimit.isExceeded())
+                    break;
+                // runs in progress on the other workers are not counted, the average is taken per worker
+                if (budgetMs != 0 && numPassed > 0 &&
+                    !fitsInBudget(startedTime, budgetMs, (numPassed + numThreads - 1) / numThreads))
+                    break;
+
+                if (maxDurationMs != 0) {
                     auto currentTime = steady_clock::now();
-                    if(duration_cast<util::milliseconds>(currentTime - startedTime).count() > maxDurationMs)
-                    {
-                        cout << "Timed out after " << duration_cast<util::milliseconds>(currentTime - startedTime).count() << "ms , passed " << i << " tests" << endl;
-                        ctx.printSummary();
-                        return true;
+                    if (duration_cast<util::milliseconds>(currentTime - startedTime).count() > maxDurationMs) {
+                        timedOut = true;
+                        break;
                     }
                 }
-                bool pass = true;
-                do {
-                    pass = true;
-                    try {
-                        savedRand = rand;
-                        if (onStartupPtr)
-                            (*onStartupPtr)();
-                        bool result = util::invokeWithGenTuple(rand, getFunc(), curGenTup);
-                        if (onCleanupPtr)
-                            (*onCleanupPtr)();
-                        stringstream failures = ctx.flushFailures();
-                        // failed expectations
-                        if (failures.rdbuf()->in_avail()) {
-                            cerr << "Falsifiable, after " << (i + 1) << " tests: ";
-                            cerr << failures.str();
-                            shrink(savedRand, util::forward<GenTuple>(curGenTup));
-                            return false;
-                        } else if (!result) {
-                            cerr << "Falsifiable, after " << (i + 1) << " tests" << endl;
-                            shrink(savedRand, util::forward<GenTuple>(curGenTup));
-                            return false;
-                        }
-                        pass = true;
-                    } catch (const Success&) {
-                        pass = true;
-                    } catch (const Discard&) {
-                        // silently discard combination
-                        pass = false;
+
+                Random rand = Random::forRun(seed, i);
+                Random savedRand(rand);
+                util::ArenaScope arenaScope(useArena);
+                stringstream failureStr;
+                RunResult result = runUntilDecided(rand, savedRand, curGenTup, workerCtx, failureStr, workerStatsPtr,
+                                                   workerGenProfilePtr, &discardLimit);
+                if (result == RunResult::DISCARD)
+                    break;
+
+                if (result == RunResult::FAIL) {
+                    lock_guard<mutex> lock(resultMutex);
+                    // keep the failure with the lowest run index
+                    if (i < failedIndex) {
+                        failedIndex = i;
+                        failureMessage = failureStr.str();
+                        failedRand = savedRand;
                     }
-                } while (!pass);
+                    break;
+                }
+                numPassed++;
             }
-        } catch (const AssertFailed& e) {
-            cerr << "Falsifiable, after " << (i + 1) << " tests: " << e.what() << " (" << e.filename << ":" << e.lineno
-                 << ")" << endl;
-            // shrink
-            shrink(savedRand, util::forward<GenTuple>(curGenTup));
-            return false;
-        } catch (const PropertyFailedBase& e) {
-            cerr << "Falsifiable, after " << (i + 1) << " tests: " << e.what() << " (" << e.filename << ":" << e.lineno
-                 << ")" << endl;
+            lock_guard<mutex> lock(resultMutex);
+            ctx.merge(workerCtx);
+            if (workerStatsPtr)
+                stats->merge(workerStats);
+            if (workerGenProfilePtr)
+                genProfile->merge(workerGenProfile);
+        });
+
+        if (failedIndex < runLimit) {
+            size_t i = failedIndex;
+            cerr << "Falsifiable, after " << (i + 1) << " tests" << failureMessage;
+            printReplayHint(i);
             // shrink
-            shrink(savedRand, util::forward<GenTuple>(curGenTup));
+            util::ArenaScope arenaScope(useArena);
+            storeFailure(seed, i, shrink(failedRand, util::forward<GenTuple>(curGenTup)));
             return false;
-        } catch (const exception& e) {
-            cerr << "Falsifiable, after " << (i + 1) << " tests - unhandled exception thrown: " << e.what() << endl;
-            // shrink
-            shrink(savedRand, util::forward<GenTuple>(curGenTup));
+        }
+
+        if (discardLimit.isExceeded()) {
+            discardLimit.printGaveUp(cerr);
+            ctx.printSummary();
             return false;
         }
 
-        cout << "OK, passed " << numRuns << " tests" << endl;
+        if (timedOut) {
+            auto currentTime = steady_clock::now();
+            cout << "Timed out after " << duration_cast<util::milliseconds>(currentTime - startedTime).count() << "ms , passed " << numPassed.load() << " tests" << endl;
+            ctx.printSummary();
+            return true;
+        }
+
+        if (budgetMs != 0)
+            cout << "OK, passed " << numPassed.load() << " tests in time budget of " << budgetMs << "ms" << endl;
+        else
+            cout << "OK, passed " << numRuns << " tests" << endl;
         ctx.printSummary();
         return true;
     }
@@ -368,51 +1043,373 @@ private:
         }
     }
 
-    template <size_t N, typename ValueTuple, typename ShrinksTuple>
-    decltype(auto) shrinkN(ValueTuple&& valueTup, ShrinksTuple&& shrinksTuple)
+    // shrink candidates are remembered by the hash of their argument tuple if all the argument types are hashable
+    static constexpr bool isCacheable = (util::Hashable<decay_t<ARGS>> && ...);
+    using ArgHashes = array<size_t, sizeof...(ARGS)>;
+
+    template <typename ValueTuple, size_t... index>
+    static ArgHashes hashArgs(const ValueTuple& valueTup, index_sequence<index...>)
     {
-        using ShrinksType = tuple_element_t<N, ValueTuple>;//tuple_element_t<N, tuple<Shrinkable<decay_t<ARGS>>...>>;
-        auto shrinks = get<N>(shrinksTuple);
-        // keep shrinking until no shrinking is possible
+        return ArgHashes{Hash<decay_t<ARGS>>()(get<index>(valueTup).getRef())...};
+    }
+
+    template <size_t N, typename Candidate>
+    static size_t hashWithCandidate(ArgHashes argHashes, const Candidate& candidate)
+    {
+        argHashes[N] = Hash<typename Candidate::type>()(candidate.getRef());
+        size_t seed = argHashes.size();
+        for (size_t hash : argHashes)
+            seed = util::hashCombine(seed, hash);
+        return seed;
+    }
+
+    // shrinks the Nth argument as far as possible, returns true if a simpler failing argument was found. Batches of
+    // candidates are evaluated on `pool` if given
+    template <size_t N>
+    bool shrinkN(ValueTuple& valueTup, ShrinkProgress& progress, ShrinkCache& cache, util::ThreadPool* pool)
+    {
+        using ShrinksType = tuple_element_t<N, ValueTuple>;
+        Stream shrinks = get<N>(valueTup).shrinks();
+        bool anyFound = false;
+        ArgHashes argHashes{};
+        bool useCache = false;
+        if constexpr (isCacheable) {
+            useCache = cache.isEnabled();
+            if (useCache)
+                argHashes = hashArgs(valueTup, make_index_sequence<sizeof...(ARGS)>{});
+        }
+        // returns true if the candidate was already found passing, otherwise sets its hash
+        auto isCached = [&](const ShrinksType& candidate, size_t& hash) {
+            if constexpr (isCacheable) {
+                if (useCache) {
+                    hash = hashWithCandidate<N>(argHashes, candidate);
+                    if (cache.contains(hash)) {
+                        progress.cacheHit();
+                        return true;
+                    }
+                }
+            }
+            return false;
+        };
+        auto accept = [&](const ShrinksType& candidate) {
+            shrinks = candidate.shrinks();
+            get<N>(valueTup) = candidate;
+            if constexpr (isCacheable) {
+                if (useCache)
+                    argHashes[N] = Hash<typename ShrinksType::type>()(candidate.getRef());
+            }
+        };
+        // keep shrinking until no shrinking is possible or a limit is reached
         while (!shrinks.isEmpty()) {
             // printShrinks(shrinks);
             auto iter = shrinks.template iterator<ShrinksType>();
+            uint64_t index = 0;  // index in shrinks of the next candidate
+            uint64_t acceptedIndex = 0;
             bool shrinkFound = false;
-            PropertyContext context;
+            string failedExpectations;
             // keep trying until failure is reproduced
-            while (iter.hasNext()) {
-                // get shrinkable
-                auto next = iter.next();
-                if (!test(util::invokeWithArgTupleWithReplace<N, Func&, ArgTuple, typename decltype(next)::type>,
-                          util::forward<ValueTuple>(valueTup), next) ||
-                    context.hasFailures()) {
-                    shrinks = next.shrinks();
-                    get<N>(valueTup) = next;
-                    shrinkFound = true;
-                    break;
+            while (iter.hasNext() && progress.canEvaluate()) {
+                if (pool) {
+                    // evaluate a batch of candidates concurrently, accepting the first failing one in stream order
+                    vector<ShrinksType> candidates;
+                    vector<size_t> hashes;
+                    vector<uint64_t> indices;
+                    size_t batchSize = progress.numEvaluable(pool->size());
+                    while (candidates.size() < batchSize && iter.hasNext()) {
+                        auto next = iter.next();
+                        size_t hash = 0;
+                        if (isCached(next, hash)) {
+                            index++;
+                            continue;
+                        }
+                        candidates.push_back(next);
+                        hashes.push_back(hash);
+                        indices.push_back(index++);
+                    }
+                    // all the candidates of the batch may have been cached
+                    if (candidates.empty())
+                        continue;
+                    progress.evaluated(candidates.size());
+
+                    vector<char> failed(candidates.size(), 0);
+                    vector<string> expectations(candidates.size());
+                    util::Histogram* evaluationHistogram = shrinkEvaluationHistogram();
+                    vector<util::Histogram> evaluationTimes(evaluationHistogram ? candidates.size() : 0);
+                    pool->run(static_cast<uint32_t>(candidates.size()), [&](uint32_t j) {
+                        PropertyContext context;
+                        util::PhaseTimer timer(evaluationHistogram ? &evaluationTimes[j] : nullptr);
+                        if (!test(util::invokeWithArgTupleWithReplace<N, Func&, ArgTuple, typename ShrinksType::type>,
+                                  util::forward<ValueTuple>(valueTup), candidates[j]) ||
+                            context.hasFailures()) {
+                            failed[j] = 1;
+                            if (context.hasFailures())
+                                expectations[j] = context.flushFailures(4).str();
+                        }
+                    });
+                    for (const auto& evaluationTime : evaluationTimes)
+                        evaluationHistogram->merge(evaluationTime);
+
+                    for (size_t j = 0; j < candidates.size(); j++) {
+                        if (!failed[j]) {
+                            if (useCache)
+                                cache.insert(hashes[j]);
+                            continue;
+                        }
+                        accept(candidates[j]);
+                        acceptedIndex = indices[j];
+                        failedExpectations = expectations[j];
+                        shrinkFound = true;
+                        break;
+                    }
+                    if (shrinkFound)
+                        break;
+                } else {
+                    PropertyContext context;
+                    // get shrinkable
+                    auto next = iter.next();
+                    uint64_t nextIndex = index++;
+                    size_t hash = 0;
+                    if (isCached(next, hash))
+                        continue;
+                    progress.evaluated(1);
+                    bool passed;
+                    {
+                        util::PhaseTimer timer(shrinkEvaluationHistogram());
+                        passed = test(
+                            util::invokeWithArgTupleWithReplace<N, Func&, ArgTuple, typename decltype(next)::type>,
+                            util::forward<ValueTuple>(valueTup), next);
+                    }
+                    if (!passed || context.hasFailures()) {
+                        accept(next);
+                        acceptedIndex = nextIndex;
+                        if (context.hasFailures())
+                            failedExpectations = context.flushFailures(4).str();
+                        shrinkFound = true;
+                        break;
+                    }
+                    if (useCache)
+                        cache.insert(hash);
                 }
             }
             if (shrinkFound) {
+                anyFound = true;
+                progress.accepted(N, acceptedIndex);
                 cout << "  shrinking found simpler failing arg " << N << ": " << Show<ValueTuple>(valueTup) << endl;
-                if (context.hasFailures())
-                    cout << "    by failed expectation: " << context.flushFailures(4).str() << endl;
+                if (!failedExpectations.empty())
+                    cout << "    by failed expectation: " << failedExpectations << endl;
             } else {
                 break;
             }
         }
         // cout << "  no more shrinking found for arg " << N << endl;
-        return get<N>(valueTup);
+        return anyFound;
+    }
+
+    template <size_t... index>
+    void shrinkEach(ValueTuple& valueTup, ShrinkProgress& progress, ShrinkCache& cache, util::ThreadPool* pool,
+                    index_sequence<index...>)
+    {
+        if (!shrinkToFixpoint) {
+            (shrinkN<index>(valueTup, progress, cache, pool), ...);
+            return;
+        }
+
+        static constexpr size_t Size = sizeof...(index);
+        const ValueTuple generatedTup = valueTup;
+        // indices of the accepted candidates of each argument, from its generated value
+        array<vector<uint64_t>, Size> argPaths;
+        array<function<bool()>, Size> shrinkArg{
+            function<bool()>([&]() { return shrinkN<index>(valueTup, progress, cache, pool); })...};
+        array<function<bool()>, Size> revisitArg{function<bool()>(
+            [&]() { return revisitN<index>(valueTup, generatedTup, argPaths[index], progress, cache); })...};
+        ShrinkSchedule schedule(Size);
+        // number of simpler failing arguments found, and its value when each argument was last shrunk
+        size_t numChanges = 0;
+        array<size_t, Size> changesSeen{};
+        // stop when every argument has been tried since the last simpler failing arguments were found. The order
+        // changes between rounds, so the arguments tried are tracked rather than counted
+        array<bool, Size> tried{};
+        size_t numTried = 0;
+        while (numTried < Size && !progress.isStopped()) {
+            for (size_t arg : schedule.order()) {
+                uint64_t evaluationsBefore = progress.numEvaluations;
+                auto startTime = steady_clock::now();
+                bool found = false;
+                if (!argPaths[arg].empty() && changesSeen[arg] != numChanges)
+                    found = revisitArg[arg]();
+                size_t pathSize = progress.path.size();
+                found = shrinkArg[arg]() || found;
+                for (size_t i = pathSize; i < progress.path.size(); i++)
+                    argPaths[arg].push_back(progress.path[i].index);
+                auto nanos = duration_cast<util::nanoseconds>(steady_clock::now() - startTime).count();
+                schedule.record(arg, progress.numEvaluations - evaluationsBefore, static_cast<uint64_t>(nanos));
+                if (found) {
+                    // shrinkN stops where the argument can't be shrunk further, the others are to be retried
+                    numChanges++;
+                    tried.fill(false);
+                    numTried = 0;
+                }
+                changesSeen[arg] = numChanges;
+                if (!tried[arg]) {
+                    tried[arg] = true;
+                    numTried++;
+                }
+                if (numTried >= Size || progress.isStopped())
+                    break;
+            }
+        }
+        // revisiting replaced parts of the path. As the shrinks of an argument don't depend on the others, the path
+        // is rebuilt argument by argument from the generated values
+        progress.path.clear();
+        for (size_t arg = 0; arg < Size; arg++) {
+            for (uint64_t pathIndex : argPaths[arg])
+                progress.path.push_back(ShrinkStep{static_cast<uint32_t>(arg), pathIndex});
+        }
+    }
+
+    /**
+     * @brief Tries again the candidates of the Nth argument that were rejected on the way to its current value
+     * @details A candidate that passed may fail once the other arguments are simplified, but the shrinks of the
+     * accepted candidates don't include it again (e.g. 0 for an integer that had to stay above another argument).
+     * Shrinks are ordered simplest first, so the candidates preceding each accepted one along `argPath` are tried,
+     * from the generated value down. The first one failing is accepted, and `argPath` is cut to lead to it.
+     * @return true if a simpler failing argument was found
+     */
+    template <size_t N>
+    bool revisitN(ValueTuple& valueTup, const ValueTuple& generatedTup, vector<uint64_t>& argPath,
+                  ShrinkProgress& progress, ShrinkCache& cache)
+    {
+        using ShrinksType = tuple_element_t<N, ValueTuple>;
+        ArgHashes argHashes{};
+        bool useCache = false;
+        if constexpr (isCacheable) {
+            useCache = cache.isEnabled();
+            if (useCache)
+                argHashes = hashArgs(valueTup, make_index_sequence<sizeof...(ARGS)>{});
+        }
+        ShrinksType node = get<N>(generatedTup);
+        for (size_t level = 0; level < argPath.size(); level++) {
+            auto iter = node.shrinks().template iterator<ShrinksType>();
+            for (uint64_t index = 0; index < argPath[level] && iter.hasNext(); index++) {
+                auto candidate = iter.next();
+                size_t hash = 0;
+                if constexpr (isCacheable) {
+                    if (useCache) {
+                        hash = hashWithCandidate<N>(argHashes, candidate);
+                        if (cache.contains(hash)) {
+                            progress.cacheHit();
+                            continue;
+                        }
+                    }
+                }
+                if (!progress.canEvaluate())
+                    return false;
+                progress.evaluated(1);
+                PropertyContext context;
+                bool passed;
+                {
+                    util::PhaseTimer timer(shrinkEvaluationHistogram());
+                    passed = test(util::invokeWithArgTupleWithReplace<N, Func&, ArgTuple, typename ShrinksType::type>,
+                                  util::forward<ValueTuple>(valueTup), candidate);
+                }
+                if (!passed || context.hasFailures()) {
+                    get<N>(valueTup) = candidate;
+                    argPath.resize(level);
+                    argPath.push_back(index);
+                    progress.accepted(N, index);
+                    cout << "  shrinking found simpler failing arg " << N << ": " << Show<ValueTuple>(valueTup) << endl;
+                    return true;
+                }
+                if (useCache)
+                    cache.insert(hash);
+            }
+            if (!iter.hasNext())
+                return false;
+            node = iter.next();
+        }
+        return false;
+    }
+
+    // generates the inputs from the choices, throwing util::ChoiceOverrun if the choices are not enough
+    decltype(auto) generateFromChoices(const vector<uint64_t>& choices, GenTuple& curGenTup)
+    {
+        auto buffer = util::make_shared<util::ChoiceBuffer>();
+        buffer->choices = choices;
+        Random rand = Random::fromChoices(buffer);
+        util::ValueOnlyScope scope(true);
+        return util::transformHeteroTupleWithArg<util::Generate>(util::forward<GenTuple>(curGenTup), rand);
+    }
+
+    // returns true if the inputs generated from the choices fail, and sets the number of choices used
+    bool failsWithChoices(const vector<uint64_t>& choices, GenTuple& curGenTup, size_t& numUsed)
+    {
+        auto buffer = util::make_shared<util::ChoiceBuffer>();
+        buffer->choices = choices;
+        Random rand = Random::fromChoices(buffer);
+        // choices the generators can't make inputs of, running out of them or throwing, are not a valid candidate:
+        // only the property function can fail
+        unique_ptr<ValueTuple> valueTup;
+        try {
+            util::ValueOnlyScope scope(true);
+            valueTup = util::make_unique<ValueTuple>(
+                util::transformHeteroTupleWithArg<util::Generate>(util::forward<GenTuple>(curGenTup), rand));
+        } catch (const exception&) {
+            numUsed = rand.getNumChoicesUsed();
+            return false;
+        }
+        numUsed = rand.getNumChoicesUsed();
+        return failsWith(*valueTup);
     }
 
-    template <size_t... index, typename ValueTuple, typename ShrinksTuple>
-    decltype(auto) shrinkEach(ValueTuple&& valueTup, ShrinksTuple&& shrinksTup, index_sequence<index...>)
+    StoredFailure shrinkByChoices(Random& savedRand, GenTuple& curGenTup)
     {
-        return util::make_tuple(
-            shrinkN<index>(util::forward<ValueTuple>(valueTup), util::forward<ShrinksTuple>(shrinksTup))...);
+        // regenerate the failed inputs, recording the choices
+        auto buffer = util::make_shared<util::ChoiceBuffer>();
+        Random recordingRand = savedRand;
+        recordingRand.recordChoices(buffer);
+        {
+            util::ValueOnlyScope scope(true);
+            auto generatedValueTup =
+                util::transformHeteroTupleWithArg<util::Generate>(util::forward<GenTuple>(curGenTup), recordingRand);
+            cout << "  with args: " << Show<decltype(generatedValueTup)>(generatedValueTup) << endl;
+        }
+        vector<uint64_t> choices = buffer->choices;
+
+        auto fails = [&](const vector<uint64_t>& candidate, size_t& numUsed) {
+            util::PhaseTimer timer(shrinkEvaluationHistogram());
+            return failsWithChoices(candidate, curGenTup, numUsed);
+        };
+        auto onAccept = [&](const vector<uint64_t>& accepted) {
+            auto valueTup = generateFromChoices(accepted, curGenTup);
+            cout << "  shrinking found simpler failing args: " << Show<decltype(valueTup)>(valueTup) << endl;
+        };
+
+        ShrinkProgress progress(maxShrinkSteps, maxShrinkEvaluations, maxShrinkDurationMs);
+        ShrinkCache cache(shrinkCacheSize);
+        util::shrinkChoices(choices, fails, onAccept, progress, cache);
+        recordShrinkStats(progress);
+        progress.print(cout);
+        auto shrunk = generateFromChoices(choices, curGenTup);
+        if (progress.isStopped())
+            cout << "  simplest args found before the limit: " << Show<decltype(shrunk)>(shrunk) << endl;
+        else
+            cout << "  simplest args found by shrinking: " << Show<decltype(shrunk)>(shrunk) << endl;
+
+        StoredFailure failure;
+        failure.byChoices = true;
+        failure.choices = choices;
+        stringstream args;
+        args << Show<decltype(shrunk)>(shrunk);
+        failure.args = args.str();
+        return failure;
     }
 
-    void shrink(Random& savedRand, GenTuple&& curGenTup)
+    // shrinks the failed inputs, returning the failure to store with its shrunk arguments
+    StoredFailure shrink(Random& savedRand, GenTuple&& curGenTup)
     {
+        if (choiceShrinking)
+            return shrinkByChoices(savedRand, curGenTup);
+
         // regenerate failed value tuple
         auto generatedValueTup =
             util::transformHeteroTupleWithArg<util::Generate>(util::forward<GenTuple>(curGenTup), savedRand);
@@ -420,11 +1417,180 @@ private:
         cout << "  with args: " << Show<decltype(generatedValueTup)>(generatedValueTup) << endl;
         // cout << (valueTup == valueTup2 ? "gen equals original" : "gen not equals original") << endl;
         static constexpr auto Size = tuple_size<GenTuple>::value;
-        auto shrinksTuple =
-            util::transformHeteroTuple<util::GetShrinks>(util::forward<decltype(generatedValueTup)>(generatedValueTup));
-        auto shrunk = shrinkEach(util::forward<decltype(generatedValueTup)>(generatedValueTup),
-                                 util::forward<decltype(shrinksTuple)>(shrinksTuple), make_index_sequence<Size>{});
-        cout << "  simplest args found by shrinking: " << Show<decltype(shrunk)>(shrunk) << endl;
+        ShrinkProgress progress(maxShrinkSteps, maxShrinkEvaluations, maxShrinkDurationMs);
+        ShrinkCache cache(shrinkCacheSize);
+        // the workers evaluating candidates in parallel are kept for the whole shrinking
+        unique_ptr<util::ThreadPool> pool;
+        if (numShrinkThreads > 1)
+            pool = util::make_unique<util::ThreadPool>(numShrinkThreads);
+        shrinkEach(generatedValueTup, progress, cache, pool.get(), make_index_sequence<Size>{});
+        recordShrinkStats(progress);
+        auto& shrunk = generatedValueTup;
+        progress.print(cout);
+        if (progress.isStopped())
+            cout << "  simplest args found before the limit: " << Show<decltype(shrunk)>(shrunk) << endl;
+        else
+            cout << "  simplest args found by shrinking: " << Show<decltype(shrunk)>(shrunk) << endl;
+
+        StoredFailure failure;
+        failure.shrinkPath = progress.path;
+        stringstream args;
+        args << Show<decltype(shrunk)>(shrunk);
+        failure.args = args.str();
+        return failure;
+    }
+
+    // takes the candidate at `index` in the shrinks of the Nth argument, returns false if there is none
+    template <size_t N>
+    static bool followShrinkStep(ValueTuple& valueTup, uint64_t index)
+    {
+        using ShrinksType = tuple_element_t<N, ValueTuple>;
+        auto iter = get<N>(valueTup).shrinks().template iterator<ShrinksType>();
+        for (uint64_t i = 0; i < index && iter.hasNext(); i++)
+            iter.next();
+        if (!iter.hasNext())
+            return false;
+        get<N>(valueTup) = iter.next();
+        return true;
+    }
+
+    // regenerates shrunk arguments by taking the accepted candidates again, returns false if the path doesn't exist
+    template <size_t... index>
+    static bool followShrinkPath(ValueTuple& valueTup, const vector<ShrinkStep>& path, index_sequence<index...>)
+    {
+        static constexpr size_t Size = sizeof...(index);
+        array<bool (*)(ValueTuple&, uint64_t), Size> followStep{&followShrinkStep<index>...};
+        for (const ShrinkStep& step : path) {
+            if (step.arg >= Size || !followStep[step.arg](valueTup, step.index))
+                return false;
+        }
+        return true;
+    }
+
+    // returns true if the property fails with the arguments
+    bool failsWith(ValueTuple& valueTup)
+    {
+        auto values = util::transformHeteroTuple<util::ShrinkableGet>(util::forward<ValueTuple>(valueTup));
+        PropertyContext context;
+        bool failed = false;
+        try {
+            if (onStartupPtr)
+                (*onStartupPtr)();
+            bool result = util::invokeWithArgs(getFunc(), values);
+            if (onCleanupPtr)
+                (*onCleanupPtr)();
+            failed = !result || context.hasFailures();
+        } catch (const Success&) {
+        } catch (const Discard&) {
+        } catch (const exception&) {
+            failed = true;
+        }
+        return failed;
+    }
+
+    bool hasDatabase() const { return !name.empty() && !databaseDir.empty(); }
+
+    // stores the failure of the run, replacing a failure stored for the same run
+    void storeFailure(uint64_t failedSeed, uint64_t runIndex, StoredFailure&& failure,
+                      const vector<uint64_t>& runChoices = {})
+    {
+        if (!hasDatabase())
+            return;
+        failure.seed = failedSeed;
+        failure.runIndex = runIndex;
+        failure.runChoices = runChoices;
+        FailureDatabase database(databaseDir);
+        vector<StoredFailure> failures = database.load(name);
+        failures.erase(std::remove_if(failures.begin(), failures.end(),
+                                      [&failure](const StoredFailure& stored) {
+                                          return stored.seed == failure.seed && stored.runIndex == failure.runIndex &&
+                                                 stored.runChoices == failure.runChoices;
+                                      }),
+                       failures.end());
+        failures.push_back(util::move(failure));
+        if (database.save(name, failures))
+            cerr << "  failure stored in " << database.getPath(name) << endl;
+    }
+
+    // random stream the stored failed run was generated from
+    static Random storedRunRandom(const StoredFailure& failure)
+    {
+        Random rand = Random::forRun(failure.seed, failure.runIndex);
+        if (!failure.runChoices.empty()) {
+            auto buffer = util::make_shared<util::ChoiceBuffer>();
+            buffer->choices = failure.runChoices;
+            rand.replayChoices(buffer);
+        }
+        return rand;
+    }
+
+    /**
+     * @brief Replays the failures stored in the database, removing the ones that pass
+     * @return false if a stored failure still fails
+     */
+    bool replayStoredFailures(GenTuple& curGenTup)
+    {
+        FailureDatabase database(databaseDir);
+        vector<StoredFailure> failures = database.load(name);
+        if (failures.empty())
+            return true;
+
+        static constexpr auto Size = tuple_size<GenTuple>::value;
+        PropertyContext ctx;
+        for (size_t i = 0; i < failures.size(); i++) {
+            StoredFailure& failure = failures[i];
+            cout << "replaying stored failure: seed " << failure.seed << ", run index " << failure.runIndex << endl;
+            util::ArenaScope arenaScope(useArena);
+
+            // shrunk arguments first, so that they are not shrunk again if they still fail
+            if (failure.byChoices) {
+                size_t numUsed = 0;
+                if (failsWithChoices(failure.choices, curGenTup, numUsed)) {
+                    auto shrunk = generateFromChoices(failure.choices, curGenTup);
+                    cerr << "Falsifiable, by stored failure of seed " << failure.seed << " at run index "
+                         << failure.runIndex << endl;
+                    cerr << "  simplest args stored: " << Show<decltype(shrunk)>(shrunk) << endl;
+                    return false;
+                }
+            } else if (!failure.shrinkPath.empty()) {
+                Random rand = storedRunRandom(failure);
+                Random savedRand(rand);
+                stringstream failureStr;
+                DiscardLimit discardLimit(maxDiscards, maxDiscardRatio, 1);
+                if (runUntilDecided(rand, savedRand, curGenTup, ctx, failureStr, nullptr, nullptr, &discardLimit) ==
+                    RunResult::FAIL) {
+                    auto valueTup =
+                        util::transformHeteroTupleWithArg<util::Generate>(util::forward<GenTuple>(curGenTup), savedRand);
+                    if (followShrinkPath(valueTup, failure.shrinkPath, make_index_sequence<Size>{}) &&
+                        failsWith(valueTup)) {
+                        cerr << "Falsifiable, by stored failure of seed " << failure.seed << " at run index "
+                             << failure.runIndex << failureStr.str();
+                        cerr << "  simplest args stored: " << Show<ValueTuple>(valueTup) << endl;
+                        return false;
+                    }
+                }
+            }
+
+            // the failed run, shrunk again
+            Random rand = storedRunRandom(failure);
+            Random savedRand(rand);
+            stringstream failureStr;
+            // a stored run discarded too often no longer reproduces the failure
+            DiscardLimit discardLimit(maxDiscards, maxDiscardRatio, 1);
+            if (runUntilDecided(rand, savedRand, curGenTup, ctx, failureStr, nullptr, nullptr, &discardLimit) ==
+                RunResult::FAIL) {
+                cerr << "Falsifiable, by stored failure of seed " << failure.seed << " at run index "
+                     << failure.runIndex << failureStr.str();
+                storeFailure(failure.seed, failure.runIndex, shrink(savedRand, util::forward<GenTuple>(curGenTup)),
+                             failure.runChoices);
+                return false;
+            }
+
+            cout << "  stored failure passes, removed from the database" << endl;
+            failures.erase(failures.begin() + i--);
+            database.save(name, failures);
+        }
+        return true;
     }
 
     Func& getFunc() { return *static_pointer_cast<Func>(funcPtr); }
@@ -560,6 +1726,24 @@ bool matrix(Callable&& callable, initializer_list<ARGS>&&... lists)
     return property(callable).matrix(util::forward<decltype(lists)>(lists)...);
 }
 
+/**
+ * @brief Defines `LLVMFuzzerTestOneInput` running the given property on each input of the fuzzer (see
+ * `Property::fuzz()`)
+ * @details The program aborts when the property fails, after shrinking, so that libFuzzer or AFL++ keeps the input.
+ * Usage:
+ * @code
+    PROPTEST_FUZZ_TARGET(proptest::property([](string s) { PROP_ASSERT(decode(encode(s)) == s); }))
+ * @endcode
+ */
+#define PROPTEST_FUZZ_TARGET(PROPERTY)                                            \
+    extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)       \
+    {                                                                             \
+        static auto proptestFuzzProperty = (PROPERTY);                            \
+        if (!proptestFuzzProperty.fuzz(data, size))                               \
+            std::abort();                                                         \
+        return 0;                                                                 \
+    }
+
 #define EXPECT_FOR_ALL(CALLABLE, ...) EXPECT_TRUE(proptest::forAll(CALLABLE, __VA_ARGS__))
 #define ASSERT_FOR_ALL(CALLABLE, ...) ASSERT_TRUE(proptest::forAll(CALLABLE, __VA_ARGS__))
 
@@ -3,6 +3,9 @@
 #include "api.hpp"
 #include "gen.hpp"
 #include "PropertyContext.hpp"
+#include "FailureDatabase.hpp"
+#include "RunStats.hpp"
+#include "util/genprofile.hpp"
 #include "util/std.hpp"
 
 #define PROP_EXPECT_STREAM(condition, a, sign, b)                                            \
@@ -69,34 +72,183 @@ namespace proptest {
 
 class Random;
 
+/**
+ * @brief Progress of a shrinking session, checked against the shrink limits of a property
+ * @details A limit of 0 means unlimited. Once a limit is reached, shrinking stops and keeps the simplest failing
+ * arguments found so far.
+ */
+struct PROPTEST_API ShrinkProgress
+{
+    ShrinkProgress(uint32_t _maxSteps, uint32_t _maxEvaluations, uint32_t _maxDurationMs);
+
+    // returns true if another candidate can be evaluated, otherwise records the limit reached
+    bool canEvaluate();
+
+    // number of candidates that can be evaluated at once, at most n
+    size_t numEvaluable(size_t n) const;
+
+    void evaluated(size_t n) { numEvaluations += n; }
+    void accepted() { numSteps++; }
+    // records the accepted candidate of argument `arg` by its index in the shrinks
+    void accepted(size_t arg, uint64_t index)
+    {
+        numSteps++;
+        path.push_back(ShrinkStep{static_cast<uint32_t>(arg), index});
+    }
+    void cacheHit() { numCacheHits++; }
+
+    bool isStopped() const { return stopReason != nullptr; }
+    uint64_t elapsedMs() const;
+
+    void print(ostream& os) const;
+
+    uint32_t maxSteps;
+    uint32_t maxEvaluations;
+    uint32_t maxDurationMs;
+
+    uint64_t numSteps;
+    uint64_t numEvaluations;
+    uint64_t numCacheHits;  // candidates skipped as already found passing
+    steady_clock::time_point startedTime;
+    const char* stopReason;  // name of the limit reached, or nullptr if shrinking is not stopped
+    vector<ShrinkStep> path;  // candidates accepted, leading from the failed arguments to the shrunk ones
+};
+
+/**
+ * @brief Bounded set of the hashes of argument tuples found passing while shrinking
+ * @details The oldest hash is evicted when the capacity is reached. A hash collision can only make shrinking skip a
+ * candidate, never report a passing one as failing.
+ */
+struct PROPTEST_API ShrinkCache
+{
+    explicit ShrinkCache(size_t _capacity);
+
+    bool isEnabled() const { return capacity != 0; }
+    bool contains(size_t hash) const;
+    void insert(size_t hash);
+
+    size_t capacity;  // disabled if 0
+    unordered_set<size_t> hashes;
+    vector<size_t> order;  // ring buffer of hashes in insertion order
+    size_t next;
+};
+
+/**
+ * @brief Order in which the arguments are shrunk in fixpoint shrinking
+ * @details Keeps the measured cost of evaluating a shrink candidate of each argument. Each round starts from the
+ * argument cheapest per evaluation, so that the expensive ones are shrunk with the others already simplified.
+ * Arguments not measured yet are taken as cheap.
+ */
+struct PROPTEST_API ShrinkSchedule
+{
+    explicit ShrinkSchedule(size_t numArgs);
+
+    // indices of the arguments, in the order to shrink them in the next round
+    vector<size_t> order() const;
+
+    void record(size_t arg, uint64_t evaluations, uint64_t nanos);
+
+    vector<uint64_t> numEvaluations;
+    vector<uint64_t> numNanos;
+};
+
+namespace util {
+
+/**
+ * @brief Shrinks a buffer of choices reproducing a failure (see `ChoiceBuffer`)
+ * @details Deletes runs of choices, zeroes them and minimizes single choices, until none of these finds a simpler
+ * buffer or a limit of `progress` is reached. A failing candidate is accepted if the choices it used are fewer than
+ * the current buffer, or as many and lexicographically smaller.
+ *
+ * @param choices buffer reproducing the failure, replaced with the simplest buffer found
+ * @param fails replays a candidate, returning true if it fails, and sets the number of choices used
+ * @param onAccept called with each buffer accepted
+ */
+PROPTEST_API void shrinkChoices(vector<uint64_t>& choices, const function<bool(const vector<uint64_t>&, size_t&)>& fails,
+                                const function<void(const vector<uint64_t>&)>& onAccept, ShrinkProgress& progress,
+                                ShrinkCache& cache);
+
+}  // namespace util
+
 class PROPTEST_API PropertyBase {
 public:
     template <typename Func, typename GenTuple>
     PropertyBase(Func* _funcPtr, GenTuple* _genTupPtr)
- : seed(util::getGlobalSeed()), numRuns(defaultNumRuns), maxDurationMs(defaultMaxDurationMs), funcPtr(_funcPtr), genTupPtr(_genTupPtr)  {}
+ : seed(util::getGlobalSeed()), numRuns(defaultNumRuns), maxDurationMs(defaultMaxDurationMs), timeBudgetMs(0), maxDiscards(0), maxDiscardRatio(DiscardLimit::defaultMaxDiscardRatio), numThreads(defaultNumThreads), numShrinkThreads(1), maxShrinkSteps(0), maxShrinkEvaluations(0), maxShrinkDurationMs(0), shrinkCacheSize(defaultShrinkCacheSize), replay(false), replayIndex(0), useArena(false), valueOnlyGeneration(true), shrinkToFixpoint(false), choiceShrinking(false), coverageGuided(false), collectStats(false), genProfiling(false), databaseDir(util::getDefaultDatabaseDir()), funcPtr(_funcPtr), genTupPtr(_genTupPtr)  {}
 
     static void setDefaultNumRuns(uint32_t);
+    static void setDefaultNumThreads(uint32_t);
+
+    /**
+     * @brief Splits a time budget across the next properties run
+     * @details Each of the next `numProperties` properties run without a time budget of its own (see
+     * `Property::setTimeBudgetMs()`) gets an equal share of the time left until the end of the budget, so that a fast
+     * property makes many runs and a slow one few. Time left unused by a property is shared by the following ones.
+     *
+     * @param totalMs Time budget of the properties, counted from now, in milliseconds
+     * @param numProperties Number of properties the budget is split across
+     */
+    static void setSuiteTimeBudget(uint32_t totalMs, uint32_t numProperties);
     static void tag(const char* filename, int lineno, string key, string value);
     static void succeed(const char* filename, int lineno, const char* condition, const stringstream& str);
     static void fail(const char* filename, int lineno, const char* condition, const stringstream& str);
     static stringstream& getLastStream();
 
 protected:
+    // current context is kept per thread, so that runs on worker threads don't interfere with each other
     static void setContext(PropertyContext* context);
-    static PropertyContext* getContext() { return context; }
-    static PropertyContext* context;
+    static PropertyContext* getContext();
 
 protected:
     bool invoke(Random& rand);
 
+    // time budget of a forAll() in milliseconds: the property's own, or a share of the suite's. 0 if there is none
+    uint32_t takeTimeBudgetMs();
+
     static uint32_t defaultNumRuns;
     static uint32_t defaultMaxDurationMs;
+    static uint32_t defaultNumThreads;
+    static uint32_t defaultShrinkCacheSize;
+
+    static mutex suiteBudgetMutex;
+    static steady_clock::time_point suiteBudgetEnd;
+    static uint32_t suiteNumPropertiesLeft;
 
     // TODO: configurations
     uint64_t seed;
     uint32_t numRuns;
 
     uint32_t maxDurationMs; // indefinitely if 0
+    uint32_t timeBudgetMs; // runs as many as fit in the budget instead of numRuns, if not 0
+
+    // the runs are given up once the discards exceed either, unlimited if 0
+    uint32_t maxDiscards;
+    double maxDiscardRatio; // discards per run
+
+    uint32_t numThreads; // runs on the calling thread if 1
+    uint32_t numShrinkThreads; // shrink candidates are tested one by one if 1
+
+    // limits of shrinking, unlimited if 0
+    uint32_t maxShrinkSteps;
+    uint32_t maxShrinkEvaluations;
+    uint32_t maxShrinkDurationMs;
+    uint32_t shrinkCacheSize; // passing shrink candidates are not remembered if 0
+
+    bool replay; // runs only the run at replayIndex if true
+    uint64_t replayIndex;
+
+    bool useArena; // shrinkables and streams of each run are allocated from a per-thread arena if true
+    bool valueOnlyGeneration; // inputs are generated without shrinks, which are rebuilt on failure, if true
+    bool shrinkToFixpoint; // arguments are shrunk in rounds until none of them can be shrunk further if true
+    bool choiceShrinking; // failed inputs are shrunk by shrinking the choices they were generated from if true
+    bool coverageGuided; // runs mutate the choices of former runs that hit new edges of instrumented code if true
+    bool collectStats; // phases of the runs and of shrinking are timed into stats if true
+    shared_ptr<RunStats> stats; // of the last forAll() collecting stats
+    bool genProfiling; // generators of the arguments are profiled into genProfile if true
+    shared_ptr<util::GenProfile> genProfile; // of the last forAll() profiling generation
+
+    string name; // key of the failures in the database, failures are not stored if empty
+    string databaseDir; // directory of the failure database, failures are not stored if empty
 
     shared_ptr<void> funcPtr;
     shared_ptr<void> genTupPtr;
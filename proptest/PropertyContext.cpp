@@ -14,6 +14,76 @@ ostream& operator<<(ostream& os, const Failure& f)
     return os;
 }
 
+void DiscardSites::add(const char* filename, int lineno)
+{
+    counts[string(filename) + ":" + to_string(lineno)]++;
+}
+
+void DiscardSites::merge(const DiscardSites& other)
+{
+    for (auto& countKV : other.counts)
+        counts[countKV.first] += countKV.second;
+}
+
+uint64_t DiscardSites::total() const
+{
+    uint64_t sum = 0;
+    for (auto& countKV : counts)
+        sum += countKV.second;
+    return sum;
+}
+
+void DiscardSites::print(ostream& os) const
+{
+    if (counts.empty())
+        return;
+    uint64_t sum = total();
+    vector<pair<string, uint64_t>> sorted(counts.begin(), counts.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const pair<string, uint64_t>& a, const pair<string, uint64_t>& b) { return a.second > b.second; });
+    os << "  discarded: " << sum << endl;
+    for (auto& countKV : sorted)
+        os << "    " << countKV.first << ": " << countKV.second << "/" << sum << " ("
+           << static_cast<double>(countKV.second) / static_cast<double>(sum) * 100 << "%)" << endl;
+}
+
+DiscardLimit::DiscardLimit(uint64_t _maxDiscards, double _maxDiscardRatio, uint64_t _numRuns)
+    : maxDiscards(_maxDiscards), maxDiscardRatio(_maxDiscardRatio), numRuns(_numRuns), numDiscards(0), numDecided(0)
+{
+}
+
+bool DiscardLimit::discarded()
+{
+    numDiscards++;
+    return !isExceeded();
+}
+
+uint64_t DiscardLimit::limit() const
+{
+    uint64_t allowed = maxDiscards != 0 ? maxDiscards : UINT64_MAX;
+    if (maxDiscardRatio > 0.0) {
+        uint64_t runs = numDecided > numRuns ? numDecided.load() : numRuns;
+        double byRatio = maxDiscardRatio * static_cast<double>(runs);
+        if (byRatio < static_cast<double>(allowed))
+            allowed = static_cast<uint64_t>(byRatio);
+    }
+    return allowed;
+}
+
+void DiscardLimit::printGaveUp(ostream& os) const
+{
+    uint64_t discards = numDiscards;
+    os << "Gave up after " << numDecided << " tests: " << discards << " discarded, more than ";
+    if (maxDiscards != 0 && limit() == maxDiscards) {
+        os << "the maximum of " << maxDiscards << " discards";
+    } else {
+        // the ratio applies to the runs to make, not to the few decided before giving up
+        uint64_t runs = numDecided > numRuns ? numDecided.load() : numRuns;
+        os << limit() << " discards (" << maxDiscardRatio << " per test for " << runs << " tests)";
+    }
+    os << endl;
+}
+
 PropertyContext::PropertyContext() : lastStreamExists(false), oldContext(PropertyBase::getContext())
 {
     PropertyBase::setContext(this);
@@ -59,13 +129,32 @@ void PropertyContext::fail(const char* filename, int lineno, const char* conditi
 
 stringstream& PropertyContext::getLastStream()
 {
-    static stringstream defaultStr;
+    thread_local stringstream defaultStr;
     if (failures.empty() || !lastStreamExists)
         return defaultStr;
 
     return failures.back().str;
 }
 
+void PropertyContext::merge(const PropertyContext& other)
+{
+    for (auto& tagKV : other.tags) {
+        auto& valueMap = tags[tagKV.first];
+        for (auto& valueKV : tagKV.second) {
+            auto valueItr = valueMap.find(valueKV.first);
+            if (valueItr != valueMap.end())
+                valueItr->second.count += valueKV.second.count;
+            else
+                valueMap.insert(valueKV);
+        }
+    }
+
+    for (auto& failure : other.failures)
+        failures.push_back(Failure(failure.filename, failure.lineno, failure.condition, failure.str));
+
+    discards.merge(other.discards);
+}
+
 stringstream PropertyContext::flushFailures(int indent)
 {
     const auto doIndent = +[](stringstream& str, int indent) {
@@ -107,6 +196,7 @@ void PropertyContext::printSummary()
                       << static_cast<double>(tag.count) / total * 100 << "%)" << endl;
         }
     }
+    discards.print(cout);
 }
 
 }  // namespace proptest
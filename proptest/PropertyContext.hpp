@@ -32,6 +32,51 @@ PROPTEST_API uint64_t getGlobalSeed();
 
 ostream& operator<<(ostream&, const Failure&);
 
+/**
+ * @brief Number of discards of each `PROP_DISCARD()` site
+ */
+struct PROPTEST_API DiscardSites
+{
+    void add(const char* filename, int lineno);
+    void merge(const DiscardSites& other);
+    uint64_t total() const;
+    bool empty() const { return counts.empty(); }
+    // the sites, most discarding first
+    void print(ostream& os) const;
+
+    map<string, uint64_t> counts;  // "file:line" -> discards
+};
+
+/**
+ * @brief Bound on the discards across the runs of a property, shared by the workers making them
+ * @details The runs are given up once the discards exceed `maxDiscards`, or `maxDiscardRatio` times the number of
+ * runs to make (or of runs made, if more, as in a time budget). A limit of 0 means unlimited.
+ */
+struct PROPTEST_API DiscardLimit
+{
+    // discards allowed per run unless set otherwise, by `Property` and `Concurrency`
+    static constexpr double defaultMaxDiscardRatio = 10.0;
+
+    DiscardLimit(uint64_t _maxDiscards, double _maxDiscardRatio, uint64_t _numRuns);
+
+    // counts a discard, returns false once the limit is exceeded
+    bool discarded();
+    // counts a run that passed or failed
+    void decided() { numDecided++; }
+    bool isExceeded() const { return numDiscards > limit(); }
+    // the number of discards allowed so far
+    uint64_t limit() const;
+
+    // tells why the runs were given up
+    void printGaveUp(ostream& os) const;
+
+    uint64_t maxDiscards;
+    double maxDiscardRatio;
+    uint64_t numRuns;
+    atomic<uint64_t> numDiscards;
+    atomic<uint64_t> numDecided;
+};
+
 struct PROPTEST_API PropertyContext
 {
     PropertyContext();
@@ -45,11 +90,17 @@ struct PROPTEST_API PropertyContext
     stringstream flushFailures(int indent = 0);
     void printSummary();
     bool hasFailures() const { return !failures.empty(); }
+    // counts a discard of a run by `PROP_DISCARD()` at the given site
+    void discard(const char* filename, int lineno) { discards.add(filename, lineno); }
+    const DiscardSites& getDiscards() const { return discards; }
+    // accumulates tags and failures of another context (e.g. of a worker thread) into this
+    void merge(const PropertyContext& other);
 
 private:
     // key -> (value -> Tag(count, detail))
     map<string, map<string, Tag> > tags;
     list<Failure> failures;
+    DiscardSites discards;
     bool lastStreamExists;
 
     PropertyContext* oldContext;
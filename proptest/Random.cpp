@@ -1,79 +1,389 @@
 #include "Random.hpp"
 #include "util/std.hpp"
+#include <cstring>
 
 namespace proptest {
 
-Random::Random(uint64_t seed) : engine(seed) {}
+namespace util {
 
-Random::Random(const Random& other) : engine(other.engine), dist(other.dist) {}
+namespace {
+
+uint64_t splitMix64(uint64_t& x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+}  // namespace
+
+Xoshiro256ss::Xoshiro256ss(uint64_t seed)
+{
+    for (int i = 0; i < 4; i++)
+        state[i] = splitMix64(seed);
+}
+
+void Xoshiro256ss::jump()
+{
+    static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL,
+                                    0x39abdc4529b1661cULL};
+
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (size_t i = 0; i < sizeof(JUMP) / sizeof(JUMP[0]); i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & (UINT64_C(1) << b)) {
+                s0 ^= state[0];
+                s1 ^= state[1];
+                s2 ^= state[2];
+                s3 ^= state[3];
+            }
+            (*this)();
+        }
+    }
+    state[0] = s0;
+    state[1] = s1;
+    state[2] = s2;
+    state[3] = s3;
+}
+
+Philox4x32::Philox4x32(uint64_t _key, uint64_t streamIndex)
+    : key{static_cast<uint32_t>(_key), static_cast<uint32_t>(_key >> 32)},
+      counter{0, 0, static_cast<uint32_t>(streamIndex), static_cast<uint32_t>(streamIndex >> 32)},
+      output{0, 0, 0, 0},
+      outputIndex(4)
+{
+}
+
+Philox4x32::result_type Philox4x32::operator()()
+{
+    if (outputIndex >= 4) {
+        block(counter, key, output);
+        // increment the block index
+        if (++counter[0] == 0)
+            ++counter[1];
+        outputIndex = 0;
+    }
+    uint64_t result = (static_cast<uint64_t>(output[outputIndex]) << 32) | output[outputIndex + 1];
+    outputIndex += 2;
+    return result;
+}
+
+void Philox4x32::block(const uint32_t _counter[4], const uint32_t _key[2], uint32_t out[4])
+{
+    static constexpr uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    static constexpr uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+    uint32_t c0 = _counter[0], c1 = _counter[1], c2 = _counter[2], c3 = _counter[3];
+    uint32_t k0 = _key[0], k1 = _key[1];
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+        uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+        uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<uint32_t>(p1);
+        c3 = static_cast<uint32_t>(p0);
+        c0 = n0;
+        c2 = n2;
+        k0 += W0;
+        k1 += W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+uint64_t signedToChoice(int64_t value, int64_t min, int64_t max)
+{
+    if (min >= 0)
+        return static_cast<uint64_t>(value) - static_cast<uint64_t>(min);
+    if (max <= 0)
+        return static_cast<uint64_t>(max) - static_cast<uint64_t>(value);
+    // 0, 1, -1, 2, -2, ... while both sides have values, then the rest of the longer side
+    uint64_t numPositive = static_cast<uint64_t>(max), numNegative = 0 - static_cast<uint64_t>(min);
+    uint64_t numAlternating = numPositive < numNegative ? numPositive : numNegative;
+    uint64_t magnitude = value >= 0 ? static_cast<uint64_t>(value) : 0 - static_cast<uint64_t>(value);
+    if (magnitude > numAlternating)
+        return numAlternating + magnitude;
+    if (value > 0)
+        return 2 * magnitude - 1;
+    return 2 * magnitude;
+}
+
+int64_t choiceToSigned(uint64_t choice, int64_t min, int64_t max)
+{
+    if (min >= 0)
+        return static_cast<int64_t>(static_cast<uint64_t>(min) + choice);
+    if (max <= 0)
+        return static_cast<int64_t>(static_cast<uint64_t>(max) - choice);
+    uint64_t numPositive = static_cast<uint64_t>(max), numNegative = 0 - static_cast<uint64_t>(min);
+    uint64_t numAlternating = numPositive < numNegative ? numPositive : numNegative;
+    uint64_t magnitude;
+    bool positive;
+    if (choice > 2 * numAlternating) {
+        magnitude = choice - numAlternating;
+        positive = numPositive > numNegative;
+    } else {
+        magnitude = (choice + 1) / 2;
+        positive = choice % 2 == 1;
+    }
+    return static_cast<int64_t>(positive ? magnitude : 0 - magnitude);
+}
+
+vector<uint64_t> choicesFromBytes(const uint8_t* data, size_t size)
+{
+    vector<uint64_t> choices;
+    choices.reserve(size);
+    size_t i = 0;
+    while (i < size) {
+        uint64_t choice = 0;
+        for (int shift = 0; i < size; shift += 7) {
+            uint8_t byte = data[i++];
+            if (shift < 64)
+                choice |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+        choices.push_back(choice);
+    }
+    return choices;
+}
+
+}  // namespace util
+
+namespace {
+
+Random::EngineType engineTypeFromEnv()
+{
+    const char* env_engine = std::getenv("PROPTEST_RANDOM_ENGINE");
+    if (env_engine && string(env_engine) == "mt19937_64")
+        return Random::EngineType::MT19937_64;
+    return Random::EngineType::XOSHIRO256SS;
+}
+
+}  // namespace
+
+Random::EngineType Random::defaultEngineType = engineTypeFromEnv();
+
+Random::Random(uint64_t seed) : Random(seed, defaultEngineType) {}
+
+Random::Random(uint64_t seed, EngineType _engineType)
+    : engineType(_engineType), engine(seed), counterEngine(seed, 0), choiceIndex(0)
+{
+    if (engineType == EngineType::MT19937_64)
+        legacyEngine = util::make_unique<mt19937_64>(seed);
+}
+
+Random::Random(const Random& other)
+    : engineType(other.engineType),
+      engine(other.engine),
+      counterEngine(other.counterEngine),
+      legacyEngine(other.legacyEngine ? util::make_unique<mt19937_64>(*other.legacyEngine) : nullptr),
+      dist(other.dist),
+      choiceBuffer(other.choiceBuffer),
+      choiceIndex(other.choiceIndex)
+{
+}
+
+Random::~Random() {}
+
+Random Random::forRun(uint64_t seed, uint64_t runIndex)
+{
+    Random rand(seed, EngineType::PHILOX4X32);
+    rand.counterEngine = util::Philox4x32(seed, runIndex);
+    return rand;
+}
 
 Random& Random::operator=(const Random& other)
 {
+    engineType = other.engineType;
     engine = other.engine;
+    counterEngine = other.counterEngine;
+    if (other.legacyEngine) {
+        if (legacyEngine)
+            *legacyEngine = *other.legacyEngine;
+        else
+            legacyEngine = util::make_unique<mt19937_64>(*other.legacyEngine);
+    } else {
+        legacyEngine.reset();
+    }
     dist = other.dist;
+    choiceBuffer = other.choiceBuffer;
+    choiceIndex = other.choiceIndex;
 
     return *this;
 }
 
+Random Random::split()
+{
+    return Random(next8U(), getEngineType());
+}
+
+void Random::jump()
+{
+    if (engineType != EngineType::XOSHIRO256SS)
+        throw runtime_error("jump is only supported for XOSHIRO256SS engine");
+    engine.jump();
+}
+
+Random::EngineType Random::getEngineType() const
+{
+    return engineType;
+}
+
+void Random::recordChoices(shared_ptr<util::ChoiceBuffer> buffer)
+{
+    size_t start = buffer->choices.size();
+    if (choiceBuffer && choiceBuffer != buffer && choiceIndex < choiceBuffer->choices.size()) {
+        auto& pending = choiceBuffer->choices;
+        buffer->choices.insert(buffer->choices.end(), pending.begin() + choiceIndex, pending.end());
+    }
+    buffer->recording = true;
+    choiceBuffer = buffer;
+    choiceIndex = start;
+}
+
+void Random::replayChoices(shared_ptr<util::ChoiceBuffer> buffer)
+{
+    buffer->recording = true;
+    choiceBuffer = buffer;
+    choiceIndex = 0;
+}
+
+Random Random::fromChoices(shared_ptr<util::ChoiceBuffer> buffer)
+{
+    Random rand(0);
+    rand.choiceBuffer = buffer;
+    return rand;
+}
+
+template <typename T, typename Dist>
+T Random::drawSigned(T min, T max, Dist& dist)
+{
+    if (!choiceBuffer)
+        return static_cast<T>(withEngine(dist));
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max)) - static_cast<uint64_t>(static_cast<int64_t>(min));
+    uint64_t choice = choose(range, [&]() { return util::signedToChoice(withEngine(dist), min, max); });
+    return static_cast<T>(util::choiceToSigned(choice, min, max));
+}
+
+template <typename T, typename Dist>
+T Random::drawUnsigned(T min, T max, Dist& dist)
+{
+    if (!choiceBuffer)
+        return static_cast<T>(withEngine(dist));
+    uint64_t range = static_cast<uint64_t>(max) - static_cast<uint64_t>(min);
+    uint64_t choice = choose(range, [&]() { return static_cast<uint64_t>(withEngine(dist)) - min; });
+    return static_cast<T>(min + choice);
+}
+
+// the choice of a floating point number is its bits, replayed as the lower bound if out of [min, max)
+template <typename T, typename Dist>
+T Random::drawFloating(T min, T max, Dist& dist)
+{
+    if (!choiceBuffer)
+        return withEngine(dist);
+    using Bits = conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+    uint64_t choice = choose(numeric_limits<Bits>::max(), [&]() {
+        T value = withEngine(dist);
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        return static_cast<uint64_t>(bits);
+    });
+    Bits bits = static_cast<Bits>(choice);
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return (value >= min && value < max) ? value : min;
+}
+
+Random::EngineType Random::getDefaultEngineType()
+{
+    return defaultEngineType;
+}
+
+void Random::setDefaultEngineType(EngineType engineType)
+{
+    defaultEngineType = engineType;
+}
+
 uint64_t Random::next8U()
 {
-    auto value = dist(engine);
-    return value;
+    return drawUnsigned<uint64_t>(0, UINT64_MAX, dist);
 }
 
 bool Random::getRandomBool(double threshold)
 {
     if(threshold == 1.0)
         return true;
-    return (next8U() <= static_cast<uint64_t>(static_cast<double>(UINT64_MAX) * threshold));
+    auto draw = [&]() {
+        return withEngine([this](auto& eng) { return dist(eng); }) <=
+               static_cast<uint64_t>(static_cast<double>(UINT64_MAX) * threshold);
+    };
+    if (choiceBuffer)
+        return choose(1, [&]() -> uint64_t { return draw() ? 1 : 0; }) == 1;
+    return draw();
 }
 
 int8_t Random::getRandomInt8(int8_t min, int8_t max)
 {
     uniform_int_distribution<int> dist(min, max);
-    return static_cast<int8_t>(dist(engine));
+    return drawSigned<int8_t>(min, max, dist);
 }
 
 uint8_t Random::getRandomUInt8(uint8_t min, uint8_t max)
 {
     uniform_int_distribution<int> dist(min, max);
-    return static_cast<uint8_t>(dist(engine));
+    return drawUnsigned<uint8_t>(min, max, dist);
 }
 
 int16_t Random::getRandomInt16(int16_t min, int16_t max)
 {
     uniform_int_distribution<int> dist(min, max);
-    return static_cast<int16_t>(dist(engine));
+    return drawSigned<int16_t>(min, max, dist);
 }
 
 uint16_t Random::getRandomUInt16(uint16_t min, uint16_t max)
 {
     uniform_int_distribution<int> dist(min, max);
-    return static_cast<uint16_t>(dist(engine));
+    return drawUnsigned<uint16_t>(min, max, dist);
 }
 
 int32_t Random::getRandomInt32(int32_t min, int32_t max)
 {
     uniform_int_distribution<int32_t> dist(min, max);
-    return static_cast<int32_t>(dist(engine));
+    return drawSigned<int32_t>(min, max, dist);
 }
 
 uint32_t Random::getRandomUInt32(uint32_t min, uint32_t max)
 {
     uniform_int_distribution<uint32_t> dist(min, max);
-    return static_cast<uint32_t>(dist(engine));
+    return drawUnsigned<uint32_t>(min, max, dist);
 }
 
 int64_t Random::getRandomInt64(int64_t min, int64_t max)
 {
     uniform_int_distribution<int64_t> dist(min, max);
-    return static_cast<int64_t>(dist(engine));
+    return drawSigned<int64_t>(min, max, dist);
 }
 
 uint64_t Random::getRandomUInt64(uint64_t min, uint64_t max)
 {
     uniform_int_distribution<uint64_t> dist(min, max);
-    return static_cast<uint64_t>(dist(engine));
+    return drawUnsigned<uint64_t>(min, max, dist);
+}
+
+void Random::fillUInt64(span<uint64_t> data)
+{
+    if (choiceBuffer) {
+        for (auto& value : data)
+            value = next8U();
+        return;
+    }
+    withEngine([&](auto& eng) {
+        for (auto& value : data)
+            value = eng();
+    });
 }
 
 // [fromIncluded, toExclued)
@@ -85,24 +395,24 @@ uint32_t Random::getRandomSize(size_t fromIncluded, size_t toExcluded)
 float Random::getRandomFloat()
 {
     uniform_real_distribution<float> dist;
-    return dist(engine);
+    return drawFloating<float>(0.0f, 1.0f, dist);
 }
 
 double Random::getRandomDouble()
 {
     uniform_real_distribution<double> dist;
-    return dist(engine);
+    return drawFloating<double>(0.0, 1.0, dist);
 }
 float Random::getRandomFloat(float min, float max)
 {
     uniform_real_distribution<float> dist(min, max);
-    return dist(engine);
+    return drawFloating<float>(min, max, dist);
 }
 
 double Random::getRandomDouble(double min, double max)
 {
     uniform_real_distribution<double> dist(min, max);
-    return dist(engine);
+    return drawFloating<double>(min, max, dist);
 }
 
 
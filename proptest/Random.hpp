@@ -7,10 +7,148 @@ namespace proptest {
 
 PROPTEST_API int64_t getCurrentTime();
 
+namespace util {
+
+// returns the upper 64 bits of the 128-bit product of a and b, storing the lower 64 bits in lo
+inline uint64_t mulHiLo64(uint64_t a, uint64_t b, uint64_t& lo)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ using uint128 = unsigned __int128;
+    uint128 product = static_cast<uint128>(a) * b;
+    lo = static_cast<uint64_t>(product);
+    return static_cast<uint64_t>(product >> 64);
+#else
+    uint64_t aLo = a & 0xFFFFFFFFULL, aHi = a >> 32;
+    uint64_t bLo = b & 0xFFFFFFFFULL, bHi = b >> 32;
+    uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFULL) + (hl & 0xFFFFFFFFULL);
+    lo = (mid << 32) | (ll & 0xFFFFFFFFULL);
+    return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+/**
+ * @brief xoshiro256** pseudo-random number generator
+ * @details Holds only 256 bits of state, so that copying is cheap. Satisfies UniformRandomBitGenerator
+ */
+struct PROPTEST_API Xoshiro256ss
+{
+    using result_type = uint64_t;
+
+    // state is initialized from the seed using SplitMix64
+    explicit Xoshiro256ss(uint64_t seed);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    // defined inline as it's called per drawn value
+    result_type operator()()
+    {
+        const uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+    static uint64_t rotl(const uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    // advances the state by 2^128 steps, equivalent to 2^128 calls to operator()
+    void jump();
+
+    uint64_t state[4];
+};
+
+/**
+ * @brief Philox4x32-10 counter-based pseudo-random number generator
+ * @details Each output block is computed directly from the key and a 128-bit counter, so that the n-th value of any
+ * stream can be obtained without generating the preceding streams. The counter holds the stream index in its upper
+ * half and the block index in its lower half. Satisfies UniformRandomBitGenerator
+ */
+struct PROPTEST_API Philox4x32
+{
+    using result_type = uint64_t;
+
+    Philox4x32(uint64_t key, uint64_t streamIndex);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()();
+
+    // computes a single output block for given counter and key
+    static void block(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]);
+
+    uint32_t key[2];
+    uint32_t counter[4];
+    uint32_t output[4];
+    uint32_t outputIndex;
+};
+
+/**
+ * @brief Choices made by a `Random`, one per drawn value
+ * @details A choice is the index of the drawn value among the values of its range, ordered from the simplest: from
+ * the value nearest to 0 for integers (0, 1, -1, 2, -2, ...), by the bits of the value for floating point numbers.
+ * A smaller choice replays as a simpler value, so that generated inputs can be shrunk by shrinking their choices,
+ * whatever generators and combinators produced them.
+ */
+struct PROPTEST_API ChoiceBuffer
+{
+    vector<uint64_t> choices;
+    bool recording = false;  // draws past the last choice are taken from the engine and appended if true
+    bool wrapping = false;   // a choice out of the range of the value drawn wraps around if true, instead of clamping
+};
+
+/**
+ * @brief Thrown when a `Random` replaying a `ChoiceBuffer` needs more choices than the buffer holds
+ */
+struct PROPTEST_API ChoiceOverrun : public runtime_error
+{
+    ChoiceOverrun() : runtime_error("choice buffer overrun") {}
+};
+
+// index of value in [min, max], counting from the value nearest to 0
+PROPTEST_API uint64_t signedToChoice(int64_t value, int64_t min, int64_t max);
+PROPTEST_API int64_t choiceToSigned(uint64_t choice, int64_t min, int64_t max);
+
+/**
+ * @brief Reads choices from bytes, each encoded as a LEB128 varint
+ * @details Any bytes are valid: small bytes give small choices, and a varint cut short by the end of the bytes is
+ * taken as it is. Used to feed a `Random` from the inputs of a fuzzer
+ */
+PROPTEST_API vector<uint64_t> choicesFromBytes(const uint8_t* data, size_t size);
+
+}  // namespace util
+
 class PROPTEST_API Random {
 public:
+    /**
+     * @brief Underlying pseudo-random number generator
+     * @details `XOSHIRO256SS` is the default. `MT19937_64` is kept for compatibility, for replaying seeds found with
+     * former versions. The default can be changed with `Random::setDefaultEngineType` or by setting environment
+     * variable `PROPTEST_RANDOM_ENGINE` to `mt19937_64`. `PHILOX4X32` is counter-based and is used for per-run streams
+     * created with `Random::forRun`.
+     */
+    enum class EngineType { XOSHIRO256SS, MT19937_64, PHILOX4X32 };
+
     Random(uint64_t seed);
+    Random(uint64_t seed, EngineType engineType);
     Random(const Random& other);
+    ~Random();
+
+    /**
+     * @brief Creates the random stream for a single run, keyed by the seed and the run index
+     * @details The stream is computed directly from (seed, runIndex) by a counter-based engine, so that any run can
+     * be regenerated without going through the preceding runs
+     */
+    static Random forRun(uint64_t seed, uint64_t runIndex);
+
     bool getRandomBool(double threshold = 0.5);
     int8_t getRandomInt8(int8_t min = INT8_MIN, int8_t max = INT8_MAX);
     uint8_t getRandomUInt8(uint8_t min = 0, uint8_t max = UINT8_MAX);
@@ -26,8 +164,89 @@ public:
     double getRandomDouble(double min, double max);
     uint32_t getRandomSize(size_t fromIncluded, size_t toExcluded);
 
+    /**
+     * @brief Fills `data` with uniformly distributed 64-bit values
+     */
+    void fillUInt64(span<uint64_t> data);
+
+    /**
+     * @brief Fills `data` with integers uniformly distributed in [min, max]
+     * @details Uses Lemire's nearly divisionless method, which takes a multiplication per value and rarely needs
+     * a division or a rejection. Considerably cheaper than calling getRandom* per value for large inputs
+     */
+    template <typename T>
+        requires is_integral_v<T>
+    void fillBounded(span<T> data, T min, T max)
+    {
+        if (max < min)
+            throw invalid_argument("invalid range");
+        // distance computed in modular arithmetic, so that signed ranges are covered as well
+        uint64_t range = static_cast<uint64_t>(max) - static_cast<uint64_t>(min);
+        if (choiceBuffer) {
+            for (auto& value : data) {
+                auto draw = [&]() { return withEngine([range](auto& eng) { return nextBounded(eng, range); }); };
+                if constexpr (is_signed_v<T>) {
+                    uint64_t choice = choose(range, [&]() {
+                        return util::signedToChoice(static_cast<T>(static_cast<uint64_t>(min) + draw()), min, max);
+                    });
+                    value = static_cast<T>(util::choiceToSigned(choice, min, max));
+                } else {
+                    value = static_cast<T>(min + choose(range, draw));
+                }
+            }
+            return;
+        }
+        withEngine([&](auto& eng) {
+            for (auto& value : data)
+                value = static_cast<T>(static_cast<uint64_t>(min) + nextBounded(eng, range));
+        });
+    }
+
     Random& operator=(const Random& other);
 
+    /**
+     * @brief Creates an independent random stream, advancing this one
+     */
+    Random split();
+
+    /**
+     * @brief Advances the stream by 2^128 draws. Only supported for `XOSHIRO256SS` engine
+     * @details Calling jump() on copies of a Random gives non-overlapping streams for parallel use
+     */
+    void jump();
+
+    EngineType getEngineType() const;
+
+    /**
+     * @brief Records the choices of the values drawn from now on into `buffer`
+     * @details The drawn values are the same as without recording. Copies of this `Random` record into the same
+     * buffer. A `Random` created by `split()` is not recorded, but is replayed from the recorded choice of its seed.
+     * Choices this `Random` has yet to replay are carried over to `buffer` and replayed from it
+     */
+    void recordChoices(shared_ptr<util::ChoiceBuffer> buffer);
+
+    /**
+     * @brief Replays the choices in `buffer` from the first one, then draws from the engine as usual
+     * @details The values drawn past the last choice are recorded into `buffer`, and a replayed choice out of the
+     * range of the value drawn is replaced with the choice taken. Used to generate inputs starting with given
+     * choices, such as mutated choices of former runs
+     */
+    void replayChoices(shared_ptr<util::ChoiceBuffer> buffer);
+
+    /**
+     * @brief Creates a `Random` drawing the values given by the choices in `buffer`, in order
+     * @details Throws `util::ChoiceOverrun` if more values are drawn than there are choices, unless the buffer is
+     * recording. A choice out of the range of the value drawn is taken as the last value of the range, or wraps
+     * around if the buffer is wrapping
+     */
+    static Random fromChoices(shared_ptr<util::ChoiceBuffer> buffer);
+
+    // number of choices recorded or replayed so far
+    size_t getNumChoicesUsed() const { return choiceIndex; }
+
+    static EngineType getDefaultEngineType();
+    static void setDefaultEngineType(EngineType engineType);
+
     template <typename T>
     T getRandom(int64_t /*min*/, int64_t /*max*/)
     {
@@ -42,9 +261,80 @@ public:
 
 private:
     uint64_t next8U();
-    // default_random_engine engine;
-    mt19937_64 engine;
+
+    // returns the next choice in [0, maxChoice], replayed from the choice buffer or drawn with `draw` and recorded
+    template <typename Draw>
+    uint64_t choose(uint64_t maxChoice, Draw&& draw)
+    {
+        auto& choices = choiceBuffer->choices;
+        if (choiceIndex < choices.size()) {
+            uint64_t& choice = choices[choiceIndex++];
+            if (choice <= maxChoice)
+                return choice;
+            uint64_t taken = choiceBuffer->wrapping ? choice % (maxChoice + 1) : maxChoice;
+            // a recording buffer keeps the choice as it was taken
+            if (choiceBuffer->recording)
+                choice = taken;
+            return taken;
+        }
+        if (!choiceBuffer->recording)
+            throw util::ChoiceOverrun();
+        uint64_t choice = draw();
+        choices.push_back(choice);
+        choiceIndex++;
+        return choice;
+    }
+
+    template <typename T, typename Dist>
+    T drawSigned(T min, T max, Dist& dist);
+
+    template <typename T, typename Dist>
+    T drawUnsigned(T min, T max, Dist& dist);
+
+    template <typename T, typename Dist>
+    T drawFloating(T min, T max, Dist& dist);
+
+    // [0, range]
+    template <typename Engine>
+    static uint64_t nextBounded(Engine& eng, uint64_t range)
+    {
+        if (range == UINT64_MAX)
+            return eng();
+        uint64_t bound = range + 1, lo;
+        uint64_t hi = util::mulHiLo64(eng(), bound, lo);
+        if (lo < bound) {
+            uint64_t threshold = (0 - bound) % bound;
+            while (lo < threshold)
+                hi = util::mulHiLo64(eng(), bound, lo);
+        }
+        return hi;
+    }
+
+    // calls func with the engine in use
+    template <typename Func>
+    decltype(auto) withEngine(Func&& func)
+    {
+        switch (engineType) {
+            case EngineType::MT19937_64:
+                return func(*legacyEngine);
+            case EngineType::PHILOX4X32:
+                return func(counterEngine);
+            default:
+                return func(engine);
+        }
+    }
+
+    EngineType engineType;
+    util::Xoshiro256ss engine;
+    util::Philox4x32 counterEngine;
+    // only allocated in compatibility mode, as it holds about 2.5KB of state
+    unique_ptr<mt19937_64> legacyEngine;
     uniform_int_distribution<uint64_t> dist;
+    // draws are recorded into or replayed from the buffer if set
+    shared_ptr<util::ChoiceBuffer> choiceBuffer;
+    size_t choiceIndex;
+
+    static EngineType defaultEngineType;
 };
 
 template <>
@@ -0,0 +1,102 @@
+#include "RunStats.hpp"
+
+namespace proptest {
+
+namespace {
+
+void printPhase(ostream& os, const char* name, const util::Histogram& histogram)
+{
+    if (histogram.count() == 0)
+        return;
+    os << "    " << name << ": " << util::formatNanos(histogram.percentile(0.5)) << " / "
+       << util::formatNanos(histogram.percentile(0.99)) << " / " << util::formatNanos(histogram.max()) << endl;
+}
+
+void printPhaseJson(ostream& os, const util::Histogram& histogram)
+{
+    os << "{\"count\":" << histogram.count() << ",\"p50Ns\":" << histogram.percentile(0.5)
+       << ",\"p99Ns\":" << histogram.percentile(0.99) << ",\"maxNs\":" << histogram.max()
+       << ",\"totalNs\":" << histogram.total() << "}";
+}
+
+void printJsonString(ostream& os, const string& str)
+{
+    os << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec
+               << std::setfill(' ');
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+}  // namespace
+
+double RunStats::runsPerSecond() const
+{
+    return runNanos == 0 ? 0.0 : static_cast<double>(numRuns) * 1e9 / static_cast<double>(runNanos);
+}
+
+void RunStats::merge(const RunStats& other)
+{
+    generation.merge(other.generation);
+    startup.merge(other.startup);
+    property.merge(other.property);
+    cleanup.merge(other.cleanup);
+    shrinkEvaluation.merge(other.shrinkEvaluation);
+    numRuns += other.numRuns;
+    numDiscards += other.numDiscards;
+    discardSites.merge(other.discardSites);
+    numShrinkEvaluations += other.numShrinkEvaluations;
+    numShrinkSteps += other.numShrinkSteps;
+}
+
+void RunStats::print(ostream& os) const
+{
+    // the precision is restored, not to change how the caller's numbers are printed afterwards
+    auto precision = os.precision();
+    os << "  stats: " << numRuns << " runs, " << numDiscards << " discarded, " << std::fixed << std::setprecision(1)
+       << runsPerSecond() << " runs/s" << std::defaultfloat << std::setprecision(precision) << endl;
+    os << "  phase latency (p50 / p99 / max):" << endl;
+    printPhase(os, "generation", generation);
+    printPhase(os, "startup", startup);
+    printPhase(os, "property", property);
+    printPhase(os, "cleanup", cleanup);
+    if (numShrinkEvaluations > 0) {
+        os << "  shrinking: " << numShrinkSteps << " steps, " << numShrinkEvaluations << " evaluations, "
+           << util::formatNanos(shrinkNanos) << endl;
+        printPhase(os, "evaluation", shrinkEvaluation);
+    }
+}
+
+void RunStats::printJson(ostream& os, const string& name) const
+{
+    auto precision = os.precision();
+    os << "{";
+    if (!name.empty()) {
+        os << "\"name\":";
+        printJsonString(os, name);
+        os << ",";
+    }
+    os << "\"runs\":" << numRuns << ",\"discards\":" << numDiscards << ",\"runsPerSecond\":" << std::fixed
+       << std::setprecision(1) << runsPerSecond() << std::defaultfloat << std::setprecision(precision)
+       << ",\"runNs\":" << runNanos;
+    os << ",\"phases\":{\"generation\":";
+    printPhaseJson(os, generation);
+    os << ",\"startup\":";
+    printPhaseJson(os, startup);
+    os << ",\"property\":";
+    printPhaseJson(os, property);
+    os << ",\"cleanup\":";
+    printPhaseJson(os, cleanup);
+    os << "},\"shrinking\":{\"evaluations\":" << numShrinkEvaluations << ",\"steps\":" << numShrinkSteps
+       << ",\"durationNs\":" << shrinkNanos << ",\"evaluation\":";
+    printPhaseJson(os, shrinkEvaluation);
+    os << "}}";
+}
+
+}  // namespace proptest
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "api.hpp"
+#include "PropertyContext.hpp"
+#include "util/histogram.hpp"
+#include "util/std.hpp"
+
+namespace proptest {
+
+/**
+ * @brief Timing of the phases of a property test, collected if enabled with `setStats(true)`
+ * @details Each phase of a run is recorded in its own histogram: generating the inputs, the startup function, the
+ * property function and the cleanup function. Shrinking is recorded apart, per candidate evaluated.
+ */
+struct PROPTEST_API RunStats
+{
+    util::Histogram generation;
+    util::Histogram startup;
+    util::Histogram property;
+    util::Histogram cleanup;
+    util::Histogram shrinkEvaluation;
+
+    uint64_t numRuns = 0;
+    uint64_t numDiscards = 0;
+    DiscardSites discardSites;  // discards of each `PROP_DISCARD()` site
+    uint64_t runNanos = 0;  // wall time of the runs, without shrinking
+
+    uint64_t numShrinkEvaluations = 0;
+    uint64_t numShrinkSteps = 0;
+    uint64_t shrinkNanos = 0;
+
+    double runsPerSecond() const;
+
+    // accumulates the phases and counts of another (e.g. of a worker thread) into this, leaving the wall times
+    void merge(const RunStats& other);
+
+    // human readable summary
+    void print(ostream& os) const;
+    // single line JSON object, with the property name if not empty
+    void printJson(ostream& os, const string& name = "") const;
+};
+
+/**
+ * @brief Times a run into the generation and property phases of `stats`, if any
+ * @details The run is timed from construction to destruction, also when it throws. The generation time is set
+ * through `generationNanos()` (see `util::invokeWithGenTuple`), and the rest is taken as the property function.
+ * Nothing is recorded if the inputs were not generated.
+ */
+struct RunTimer
+{
+    explicit RunTimer(RunStats* _stats) : stats(_stats)
+    {
+        if (stats)
+            startTime = steady_clock::now();
+    }
+
+    ~RunTimer()
+    {
+        if (!stats || generated == UINT64_MAX)
+            return;
+        auto nanos = static_cast<uint64_t>(duration_cast<util::nanoseconds>(steady_clock::now() - startTime).count());
+        stats->generation.record(generated);
+        stats->property.record(nanos > generated ? nanos - generated : 0);
+    }
+
+    // where to set the generation time, nullptr if not timed
+    uint64_t* generationNanos() { return stats ? &generated : nullptr; }
+
+    RunStats* stats;
+    steady_clock::time_point startTime;
+    uint64_t generated = UINT64_MAX;
+};
+
+}  // namespace proptest
@@ -31,32 +31,57 @@ Stream StreamFunction::operator()(const ShrinkableAny& in) {
     return func(in);
 }
 
+namespace {
+thread_local bool valueOnly = false;
+}
+
+ValueOnlyScope::ValueOnlyScope(bool enabled) : prevValueOnly(valueOnly)
+{
+    if (enabled)
+        valueOnly = true;
+}
+
+ValueOnlyScope::~ValueOnlyScope()
+{
+    valueOnly = prevValueOnly;
+}
+
+bool isValueOnly()
+{
+    return valueOnly;
+}
+
 } // namespace util
 
 
 
-ShrinkableAny::ShrinkableAny(shared_ptr<Any> p) : ptr(p), shrinksPtr(emptyPtr()) {}
-ShrinkableAny::ShrinkableAny(const ShrinkableAny& other) : ptr(other.ptr), shrinksPtr(other.shrinksPtr) {}
+ShrinkableAny::ShrinkableAny(shared_ptr<Any> p) : any(*p), shrinksPtr(emptyPtr()) {}
+ShrinkableAny::ShrinkableAny(const Any& a) : any(a), shrinksPtr(emptyPtr()) {}
+ShrinkableAny::ShrinkableAny(const ShrinkableAny& other) : any(other.any), shrinksPtr(other.shrinksPtr) {}
 ShrinkableAny::~ShrinkableAny() {}
 
 ShrinkableAny& ShrinkableAny::operator=(const ShrinkableAny& other)
 {
-    ptr = other.ptr;
+    any = other.any;
     shrinksPtr = other.shrinksPtr;
     return *this;
 }
 
 ShrinkableAny ShrinkableAny::with(function<Stream()> _shrinks) const
 {
-    return ShrinkableAny(ptr, util::make_shared<decltype(_shrinks)>(_shrinks));
+    if (util::isValueOnly())
+        return ShrinkableAny(any);
+    return ShrinkableAny(any, util::make_shared_in_arena<decltype(_shrinks)>(_shrinks));
 }
 
 ShrinkableAny ShrinkableAny::with(shared_ptr<function<Stream()>> newShrinksPtr) const
 {
-    return ShrinkableAny(ptr, newShrinksPtr);
+    if (util::isValueOnly())
+        return ShrinkableAny(any);
+    return ShrinkableAny(any, newShrinksPtr);
 }
 
-Any& ShrinkableAny::getAnyRef() const { return *ptr; }
+const Any& ShrinkableAny::getAnyRef() const { return any; }
 
 ShrinkableAny ShrinkableAny::map(util::AnyFunction transformer) const
 {
@@ -67,7 +92,7 @@ ShrinkableAny ShrinkableAny::map(util::AnyFunction transformer) const
 ShrinkableAny ShrinkableAny::map(shared_ptr<util::AnyFunction> transformerPtr) const
 {
     auto thisShrinksPtr = shrinksPtr;
-    ShrinkableAny shrinkable(util::make_shared<Any>((*transformerPtr)(getAnyRef())));
+    ShrinkableAny shrinkable((*transformerPtr)(getAnyRef()));
     return shrinkable.with([thisShrinksPtr, transformerPtr]() {
         return (*thisShrinksPtr)().template transform<ShrinkableAny, ShrinkableAny>(
             [transformerPtr](const ShrinkableAny& shr) { return shr.map(transformerPtr); });
@@ -77,7 +102,7 @@ ShrinkableAny ShrinkableAny::map(shared_ptr<util::AnyFunction> transformerPtr) c
 ShrinkableAny ShrinkableAny::map(shared_ptr<function<Any(const Any&)>> transformerPtr) const
 {
     auto thisShrinksPtr = shrinksPtr;
-    ShrinkableAny shrinkable(util::make_shared<Any>((*transformerPtr)(getAnyRef())));
+    ShrinkableAny shrinkable((*transformerPtr)(getAnyRef()));
     return shrinkable.with([thisShrinksPtr, transformerPtr]() {
         return (*thisShrinksPtr)().template transform<ShrinkableAny, ShrinkableAny>(
             [transformerPtr](const ShrinkableAny& shr) { return shr.map(transformerPtr); });
@@ -126,20 +151,8 @@ ShrinkableAny ShrinkableAny::filter(util::BoolFunction criteria) const
 
 ShrinkableAny ShrinkableAny::filter(shared_ptr<util::BoolFunction> criteriaPtr) const
 {
-    if (!(*criteriaPtr)(getAnyRef()))
-        throw invalid_argument("cannot apply criteria");
-
-    auto thisShrinksPtr = shrinksPtr;
-
-    return with([thisShrinksPtr, criteriaPtr]() {
-        auto criteriaForStream = util::make_shared<function<bool(const ShrinkableAny&)>>(
-            [criteriaPtr](const ShrinkableAny& shr) -> bool { return (*criteriaPtr)(shr.getAnyRef()); });
-        // filter stream's value, and then transform each shrinkable to call filter recursively
-        return (*thisShrinksPtr)()
-            .filter(criteriaForStream)
-            .template transform<ShrinkableAny, ShrinkableAny>(
-                [criteriaPtr](const ShrinkableAny& shr) { return shr.filter(criteriaPtr); });
-    });
+    return filterShrinkable(util::make_shared<function<bool(const ShrinkableAny&)>>(
+        [criteriaPtr](const ShrinkableAny& shr) -> bool { return (*criteriaPtr)(shr.getAnyRef()); }));
 }
 
 // provide filtered generation, shrinking
@@ -151,48 +164,38 @@ ShrinkableAny ShrinkableAny::filter(util::BoolFunction criteria, int tolerance)
 
 ShrinkableAny ShrinkableAny::filter(shared_ptr<util::BoolFunction> criteriaPtr, int tolerance) const
 {
-    if (!(*criteriaPtr)(getAnyRef()))
+    return filterShrinkable(util::make_shared<function<bool(const ShrinkableAny&)>>(
+                                [criteriaPtr](const ShrinkableAny& shr) -> bool { return (*criteriaPtr)(shr.getAnyRef()); }),
+                            tolerance);
+}
+
+ShrinkableAny ShrinkableAny::filter(shared_ptr<function<bool(const Any&)>> criteriaPtr, int tolerance) const
+{
+    return filterShrinkable(util::make_shared<function<bool(const ShrinkableAny&)>>(
+                                [criteriaPtr](const ShrinkableAny& shr) -> bool { return (*criteriaPtr)(shr.getAnyRef()); }),
+                            tolerance);
+}
+
+ShrinkableAny ShrinkableAny::filterShrinkable(shared_ptr<function<bool(const ShrinkableAny&)>> criteriaPtr) const
+{
+    if (!(*criteriaPtr)(*this))
         throw invalid_argument("cannot apply criteria");
 
     auto thisShrinksPtr = shrinksPtr;
 
-    static function<Stream(const Stream&,
-                                            shared_ptr<function<bool(const ShrinkableAny&)>>,
-                                            int)> filterStream =
-        [](const Stream& stream,
-            shared_ptr<function<bool(const ShrinkableAny&)>> _criteriaPtr,
-            int _tolerance) -> Stream {
-        if (stream.isEmpty()) {
-            return Stream::empty();
-        } else {
-            for (auto itr = stream.iterator<ShrinkableAny>(); itr.hasNext();) {
-                const ShrinkableAny& shr = itr.next();
-                if ((*_criteriaPtr)(shr)) {
-                    auto tail = itr.stream;
-                    return Stream{shr, [_criteriaPtr, tail, _tolerance]() { return filterStream(tail, _criteriaPtr, _tolerance); }};
-                } else {
-                    // extract from shr's children
-                    auto tail = itr.stream;
-                    return filterStream(shr.shrinks().take(_tolerance).concat(tail), _criteriaPtr, _tolerance);
-                }
-            }
-            return Stream::empty();
-        }
-    };
-
-    return with([thisShrinksPtr, criteriaPtr, tolerance]() {
-        auto criteriaForStream = util::make_shared<function<bool(const ShrinkableAny&)>>(
-            [criteriaPtr](const ShrinkableAny& shr) -> bool { return (*criteriaPtr)(shr.getAnyRef()); });
+    return with([thisShrinksPtr, criteriaPtr]() {
         // filter stream's value, and then transform each shrinkable to call filter recursively
-        return filterStream((*thisShrinksPtr)(), criteriaForStream, tolerance)
+        return (*thisShrinksPtr)()
+            .filter(criteriaPtr)
             .template transform<ShrinkableAny, ShrinkableAny>(
-                [criteriaPtr, tolerance](const ShrinkableAny& shr) { return shr.filter(criteriaPtr, tolerance); });
+                [criteriaPtr](const ShrinkableAny& shr) { return shr.filterShrinkable(criteriaPtr); });
     });
 }
 
-ShrinkableAny ShrinkableAny::filter(shared_ptr<function<bool(const Any&)>> criteriaPtr, int tolerance) const
+ShrinkableAny ShrinkableAny::filterShrinkable(shared_ptr<function<bool(const ShrinkableAny&)>> criteriaPtr,
+                                              int tolerance) const
 {
-    if (!(*criteriaPtr)(getAnyRef()))
+    if (!(*criteriaPtr)(*this))
         throw invalid_argument("cannot apply criteria");
 
     auto thisShrinksPtr = shrinksPtr;
@@ -222,12 +225,10 @@ ShrinkableAny ShrinkableAny::filter(shared_ptr<function<bool(const Any&)>> crite
     };
 
     return with([thisShrinksPtr, criteriaPtr, tolerance]() {
-        auto criteriaForStream = util::make_shared<function<bool(const ShrinkableAny&)>>(
-            [criteriaPtr](const ShrinkableAny& shr) -> bool { return (*criteriaPtr)(shr.getAnyRef()); });
         // filter stream's value, and then transform each shrinkable to call filter recursively
-        return filterStream((*thisShrinksPtr)(), criteriaForStream, tolerance)
+        return filterStream((*thisShrinksPtr)(), criteriaPtr, tolerance)
             .template transform<ShrinkableAny, ShrinkableAny>(
-                [criteriaPtr, tolerance](const ShrinkableAny& shr) { return shr.filter(criteriaPtr, tolerance); });
+                [criteriaPtr, tolerance](const ShrinkableAny& shr) { return shr.filterShrinkable(criteriaPtr, tolerance); });
     });
 }
 
@@ -315,7 +316,28 @@ ShrinkableAny ShrinkableAny::take(int n) const
     });
 }
 
-ShrinkableAny::ShrinkableAny(shared_ptr<Any> p, shared_ptr<function<Stream()>> s)  : ptr(p), shrinksPtr(s) { }
+ShrinkableAny ShrinkableAny::memoize() const
+{
+    struct MemoCell
+    {
+        once_flag flag;
+        Stream shrinks;
+    };
+
+    auto thisShrinksPtr = shrinksPtr;
+    auto cell = util::make_shared<MemoCell>();
+    return with([thisShrinksPtr, cell]() {
+        call_once(cell->flag, [&thisShrinksPtr, &cell]() {
+            cell->shrinks = (*thisShrinksPtr)()
+                                .template transform<ShrinkableAny, ShrinkableAny>(
+                                    [](const ShrinkableAny& shr) { return shr.memoize(); })
+                                .memoize();
+        });
+        return cell->shrinks;
+    });
+}
+
+ShrinkableAny::ShrinkableAny(const Any& a, shared_ptr<function<Stream()>> s) : any(a), shrinksPtr(s) {}
 
 Stream ShrinkableAny::shrinks() const { return (*shrinksPtr)(); }
 
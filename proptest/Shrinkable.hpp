@@ -20,6 +20,27 @@ ShrinkableAny make_shrinkable_any(Args&&... args);
 
 namespace util {
 
+/**
+ * @brief Makes the shrinkables created on this thread during its lifetime carry their values only
+ * @details Shrinks are not attached, so generating a value doesn't build the closures of its shrink tree. Used while
+ * generating the inputs of a run, as the inputs of a failed run are regenerated with their shrinks before shrinking.
+ * Does nothing if not enabled.
+ */
+struct PROPTEST_API ValueOnlyScope
+{
+    explicit ValueOnlyScope(bool enabled = true);
+    ~ValueOnlyScope();
+
+    ValueOnlyScope(const ValueOnlyScope&) = delete;
+    ValueOnlyScope& operator=(const ValueOnlyScope&) = delete;
+
+private:
+    bool prevValueOnly;
+};
+
+// true if shrinkables are created without shrinks on this thread (see `ValueOnlyScope`)
+PROPTEST_API bool isValueOnly();
+
 struct AnyFunction
 {
     using F = function<Any(const Any&)>;
@@ -84,9 +105,16 @@ struct StreamFunction
 
 }
 
+/**
+ * @brief Type-erased shrinkable, holding a value and a lazy stream of its shrinks
+ * @details The value is kept in an `Any`, which points to the value in a single allocation. Type-erased operations
+ * are used where shrinkables of different types are handled together, e.g. elements of containers in `VectorShrinker`.
+ * `Shrinkable<T>` provides typed operations on top of it.
+ */
 struct PROPTEST_API ShrinkableAny
 {
     ShrinkableAny(shared_ptr<Any> p);
+    ShrinkableAny(const Any& a, shared_ptr<function<Stream()>> s);
     ShrinkableAny(const ShrinkableAny& other);
     virtual ~ShrinkableAny();
 
@@ -96,7 +124,7 @@ struct PROPTEST_API ShrinkableAny
 
     ShrinkableAny with(shared_ptr<function<Stream()>> newShrinksPtr) const;
 
-    Any& getAnyRef() const;
+    const Any& getAnyRef() const;
 
     ShrinkableAny map(util::AnyFunction transformer) const;
 
@@ -146,16 +174,23 @@ struct PROPTEST_API ShrinkableAny
 
     ShrinkableAny take(int n) const;
 
+    // memoize: evaluates each node of the shrink tree only once, however many times it is walked
+    ShrinkableAny memoize() const;
+
     template <typename T>
     Shrinkable<T> as() const;
 
 public:
-    shared_ptr<Any> ptr;
+    Any any;
     shared_ptr<function<Stream()>> shrinksPtr;
 
 protected:
+    explicit ShrinkableAny(const Any& a);
 
-    ShrinkableAny(shared_ptr<Any> p, shared_ptr<function<Stream()>> s);
+    // filter on the shrinkables themselves, used by the typed and type-erased filters
+    ShrinkableAny filterShrinkable(shared_ptr<function<bool(const ShrinkableAny&)>> criteriaPtr) const;
+
+    ShrinkableAny filterShrinkable(shared_ptr<function<bool(const ShrinkableAny&)>> criteriaPtr, int tolerance) const;
 
     static shared_ptr<function<Stream()>> emptyPtr();
 
@@ -177,21 +212,23 @@ struct Shrinkable : public ShrinkableAny
 
     Shrinkable& operator=(const Shrinkable& other)
     {
-        ptr = other.ptr;
+        any = other.any;
         shrinksPtr = other.shrinksPtr;
         return *this;
     }
 
     // operator T() const { return get(); }
-    T get() const { return *static_pointer_cast<T>(ptr->ptr); }
-    T* getPtr() const { return static_pointer_cast<T>(ptr->ptr).get(); }
-    T& getRef() const { return *static_pointer_cast<T>(ptr->ptr).get(); }
-    shared_ptr<T> getSharedPtr() const { return static_pointer_cast<T>(ptr->ptr); }
+    T get() const { return *getPtr(); }
+    T* getPtr() const { return static_cast<T*>(any.ptr.get()); }
+    T& getRef() const { return *getPtr(); }
+    shared_ptr<T> getSharedPtr() const { return static_pointer_cast<T>(any.ptr); }
+
+    // map, flatMap, mapShrinkable and filter call the given functions on T directly, without Any conversions
 
     template <typename U>
     Shrinkable<U> map(function<U(const T&)> transformer) const
     {
-        return Shrinkable<U>(ShrinkableAny::map(transformer));
+        return map<U>(util::make_shared<function<U(const T&)>>(util::move(transformer)));
     }
 
     template <typename U>
@@ -200,28 +237,81 @@ struct Shrinkable : public ShrinkableAny
         return Shrinkable<U>(ShrinkableAny::map(transformer));
     }
 
+    template <typename U, typename F>
+        requires(invocable<F&, T&>)
+    Shrinkable<U> map(shared_ptr<F> transformerPtr) const
+    {
+        auto thisShrinksPtr = shrinksPtr;
+        Shrinkable<U> shrinkable = make_shrinkable<U>((*transformerPtr)(getRef()));
+        if (util::isValueOnly())
+            return shrinkable;
+        return shrinkable.with([thisShrinksPtr, transformerPtr]() {
+            return (*thisShrinksPtr)().template transform<ShrinkableAny, ShrinkableAny>(
+                [transformerPtr](const ShrinkableAny& shr) -> ShrinkableAny {
+                    return Shrinkable<T>(shr).template map<U>(transformerPtr);
+                });
+        });
+    }
+
     template <typename U>
     Shrinkable<U> flatMap(function<Shrinkable<U>(const T&)> transformer) const
     {
-        return Shrinkable<U>(ShrinkableAny::flatMap(transformer));
+        return flatMap<U>(util::make_shared<function<Shrinkable<U>(const T&)>>(util::move(transformer)));
+    }
+
+    template <typename U, typename F>
+        requires(invocable<F&, T&>)
+    Shrinkable<U> flatMap(shared_ptr<F> transformerPtr) const
+    {
+        auto thisShrinksPtr = shrinksPtr;
+        Shrinkable<U> shrinkable = (*transformerPtr)(getRef());
+        if (util::isValueOnly())
+            return shrinkable;
+        return shrinkable.with([thisShrinksPtr, transformerPtr]() {
+            return (*thisShrinksPtr)().template transform<ShrinkableAny, ShrinkableAny>(
+                [transformerPtr](const ShrinkableAny& shr) -> ShrinkableAny {
+                    return Shrinkable<T>(shr).template flatMap<U>(transformerPtr);
+                });
+        });
     }
 
     template <typename U>
     Shrinkable<U> mapShrinkable(function<Shrinkable<U>(const Shrinkable<T>&)> transformer) const
     {
-        return Shrinkable<U>(ShrinkableAny::mapShrinkable(transformer));
+        return mapShrinkable<U>(
+            util::make_shared<function<Shrinkable<U>(const Shrinkable<T>&)>>(util::move(transformer)));
+    }
+
+    template <typename U>
+    Shrinkable<U> mapShrinkable(shared_ptr<function<Shrinkable<U>(const Shrinkable<T>&)>> transformerPtr) const
+    {
+        auto thisShrinksPtr = shrinksPtr;
+        Shrinkable<U> shrinkable = (*transformerPtr)(*this);
+        return shrinkable.with([thisShrinksPtr, transformerPtr]() {
+            return (*thisShrinksPtr)().template transform<ShrinkableAny, ShrinkableAny>(
+                [transformerPtr](const ShrinkableAny& shr) -> ShrinkableAny {
+                    return Shrinkable<T>(shr).template mapShrinkable<U>(transformerPtr);
+                });
+        });
     }
 
     // provide filtered generation, shrinking
     Shrinkable<T> filter(function<bool(const T&)> criteria) const
     {
-        return Shrinkable(ShrinkableAny::filter(criteria));
+        return Shrinkable(filterShrinkable(typedCriteria(util::make_shared<decltype(criteria)>(criteria))));
     }
 
     // provide filtered generation, shrinking
     Shrinkable<T> filter(function<bool(const T&)> criteria, int tolerance) const
     {
-        return Shrinkable(ShrinkableAny::filter(criteria, tolerance));
+        return filter(util::make_shared<decltype(criteria)>(criteria), tolerance);
+    }
+
+    template <typename F>
+        requires(invocable<F&, T&>)
+    Shrinkable<T> filter(shared_ptr<F> criteriaPtr, int tolerance) const
+    {
+        return Shrinkable(filterShrinkable(typedCriteria(criteriaPtr), tolerance));
     }
 
     Shrinkable<T> filter(shared_ptr<function<bool(const Any&)>> criteriaPtr, int tolerance) const
@@ -257,8 +347,22 @@ struct Shrinkable : public ShrinkableAny
         return Shrinkable(ShrinkableAny::take(n));
     }
 
+    Shrinkable<T> memoize() const
+    {
+        return Shrinkable(ShrinkableAny::memoize());
+    }
+
 private:
-    Shrinkable(shared_ptr<Any> p, shared_ptr<function<Stream()>> s) : ShrinkableAny(p, s) { }
+    explicit Shrinkable(const Any& a) : ShrinkableAny(a) {}
+
+    template <typename F>
+    static shared_ptr<function<bool(const ShrinkableAny&)>> typedCriteria(shared_ptr<F> criteriaPtr)
+    {
+        return util::make_shared<function<bool(const ShrinkableAny&)>>(
+            [criteriaPtr](const ShrinkableAny& shr) -> bool {
+                return (*criteriaPtr)(*static_cast<T*>(shr.any.ptr.get()));
+            });
+    }
 
 
 public:
@@ -355,14 +459,14 @@ Shrinkable<T> ShrinkableAny::as() const {
 template <typename T, typename... Args>
 Shrinkable<T> make_shrinkable(Args&&... args)
 {
-    Shrinkable<T> shrinkable(util::make_shared<Any>(util::make_any<T>(args...)));
+    Shrinkable<T> shrinkable(util::make_any<T>(args...));
     return shrinkable;
 }
 
 template <typename T, typename... Args>
 ShrinkableAny make_shrinkable_any(Args&&... args)
 {
-    ShrinkableAny shrinkable(util::make_shared<Any>(util::make_any<T>(args...)));
+    ShrinkableAny shrinkable(util::make_any<T>(args...));
     return shrinkable;
 }
 
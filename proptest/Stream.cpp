@@ -2,26 +2,26 @@
 
 namespace proptest {
 
+StreamNode::~StreamNode() {}
 
 Stream::Stream() {
 }
 
-Stream::Stream(const Stream& other) : headPtr(other.headPtr), tailGen(other.tailGen) {
+Stream::Stream(const Stream& other) : node(other.node) {
 }
 
-Stream::Stream(const shared_ptr<Stream>& other) : headPtr(other->headPtr), tailGen(other->tailGen) {
+Stream::Stream(const shared_ptr<Stream>& other) : node(other->node) {
 }
 
 Stream& Stream::operator=(const Stream& other)
 {
-    headPtr = other.headPtr;
-    tailGen = other.tailGen;
+    node = other.node;
 
     return *this;
 }
 
 bool Stream::isEmpty() const {
-    return !static_cast<bool>(headPtr);
+    return !static_cast<bool>(node);
 }
 
 Stream Stream::tail() const
@@ -29,7 +29,22 @@ Stream Stream::tail() const
     if (isEmpty())
         return Stream();
 
-    return Stream((*tailGen)());
+    if (node->isMemoized()) {
+        StreamNodeMemo* thisNode = static_cast<StreamNodeMemo*>(node.get());
+        call_once(thisNode->memoFlag, [thisNode]() {
+            if (thisNode->tailGen) {
+                thisNode->memoTail = thisNode->tailGen().node;
+                // the thunk is no longer needed, release its captures
+                thisNode->tailGen = StreamNode::TailGen();
+            }
+        });
+        return fromNode(thisNode->memoTail);
+    }
+
+    if (!node->tailGen)
+        return Stream();
+
+    return node->tailGen();
 }
 
 Stream Stream::concat(const Stream& other) const
@@ -37,8 +52,10 @@ Stream Stream::concat(const Stream& other) const
     if (isEmpty())
         return other;
     else {
-        return Stream(headPtr,
-                            [tailGen = this->tailGen, other]() { return Stream((*tailGen)()).concat(other); });
+        // the new node shares the head of this node
+        auto thisNode = node;
+        return fromNode(util::make_shared_in_arena<StreamNodeRef>(
+            node, node->head, StreamNode::TailGen([thisNode, other]() { return fromNode(thisNode).tail().concat(other); })));
     }
 }
 
@@ -47,14 +64,37 @@ Stream Stream::take(int n) const
     if (isEmpty())
         return empty();
     else {
-        auto self = *this;
         if (n == 0)
             return Stream::empty();
 
-        return Stream(headPtr, [self, n]() { return Stream(self.tail()).take(n - 1); });
+        auto thisNode = node;
+        return fromNode(util::make_shared_in_arena<StreamNodeRef>(
+            node, node->head, StreamNode::TailGen([thisNode, n]() { return fromNode(thisNode).tail().take(n - 1); })));
     }
 }
 
+Stream Stream::memoize() const
+{
+    if (isEmpty() || isMemoized())
+        return *this;
+
+    auto thisNode = node;
+    return fromNode(util::make_shared_in_arena<StreamNodeMemo>(
+        node, node->head, StreamNode::TailGen([thisNode]() { return fromNode(thisNode).tail().memoize(); })));
+}
+
+bool Stream::isMemoized() const
+{
+    return !isEmpty() && node->isMemoized();
+}
+
+Stream Stream::fromNode(shared_ptr<StreamNode> node)
+{
+    Stream stream;
+    stream.node = node;
+    return stream;
+}
+
 Stream Stream::empty() { return Stream(); }
 
 function<Stream()> Stream::done()
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "api.hpp"
+#include "util/arena.hpp"
+#include "util/smallfunction.hpp"
 #include "util/std.hpp"
 
 namespace proptest {
@@ -8,27 +10,93 @@ namespace proptest {
 template <typename T>
 struct Iterator;
 
+template <typename T>
+struct TypedStream;
+
+struct Stream;
+
+/**
+ * @brief A node of a stream, holding the address of its head and the thunk producing the rest of the stream
+ * @details The head is stored in the same allocation as the node (see `StreamNodeOf`), or kept alive by an owner
+ * shared with another node or given by the user (see `StreamNodeRef`).
+ */
+struct PROPTEST_API StreamNode
+{
+    using TailGen = util::SmallFunction<Stream()>;
+
+    StreamNode(const void* _head, TailGen&& _tailGen) : head(_head), tailGen(util::move(_tailGen)) {}
+    virtual ~StreamNode();
+
+    // true for a `StreamNodeMemo`
+    virtual bool isMemoized() const { return false; }
+
+    const void* head;
+    TailGen tailGen;  // empty if this is the last element
+};
+
+template <typename T>
+struct StreamNodeOf final : public StreamNode
+{
+    StreamNodeOf(const T& h, TailGen&& _tailGen) : StreamNode(&value, util::move(_tailGen)), value(h) {}
+
+    T value;
+};
+
+struct StreamNodeRef final : public StreamNode
+{
+    StreamNodeRef(shared_ptr<const void> _owner, const void* _head, TailGen&& _tailGen)
+        : StreamNode(_head, util::move(_tailGen)), owner(util::move(_owner))
+    {
+    }
+
+    shared_ptr<const void> owner;
+};
+
+/**
+ * @brief A node of a memoized stream (see `Stream::memoize()`), evaluating `tailGen` once and keeping the result
+ * @details The memo is kept apart from `StreamNode`, so that the nodes of streams not memoized don't carry it.
+ */
+struct StreamNodeMemo final : public StreamNode
+{
+    StreamNodeMemo(shared_ptr<const void> _owner, const void* _head, TailGen&& _tailGen)
+        : StreamNode(_head, util::move(_tailGen)), owner(util::move(_owner))
+    {
+    }
+
+    bool isMemoized() const override { return true; }
+
+    shared_ptr<const void> owner;
+    once_flag memoFlag;
+    shared_ptr<StreamNode> memoTail;
+};
+
+/**
+ * @brief Lazy, type-erased stream of values
+ * @details Each element is a single allocation holding the head value and a small-buffer thunk for the tail, taken from
+ * the current arena if any (see `util::ArenaScope`). Use `TypedStream<T>` for typed access to the elements without
+ * copying them out.
+ */
 struct PROPTEST_API Stream
 {
     Stream();
     Stream(const Stream& other);
     Stream(const shared_ptr<Stream>& other);
 
-    template <typename T>
-    Stream(const shared_ptr<T>& h, function<Stream()> gen)
-        : headPtr(static_pointer_cast<void>(h)), tailGen(util::make_shared<function<Stream()>>(gen))
+    template <typename T, typename F>
+    Stream(const shared_ptr<T>& h, F&& gen)
+        : node(util::make_shared_in_arena<StreamNodeRef>(h, h.get(), StreamNode::TailGen(util::forward<F>(gen))))
     {
     }
 
-    template <typename T>
-    Stream(const T& h, function<Stream()> gen)
-        : headPtr(static_pointer_cast<void>(util::make_shared<T>(h))), tailGen(util::make_shared<function<Stream()>>(gen))
+    template <typename T, typename F>
+    Stream(const T& h, F&& gen)
+        : node(util::make_shared_in_arena<StreamNodeOf<T>>(h, StreamNode::TailGen(util::forward<F>(gen))))
     {
     }
 
-
     template <typename T>
-    Stream(const T& h) : headPtr(static_pointer_cast<void>(util::make_shared<T>(h))), tailGen(util::make_shared<function<Stream()>>(done()))
+        requires(!std::is_base_of_v<Stream, T>)
+    Stream(const T& h) : node(util::make_shared_in_arena<StreamNodeOf<T>>(h, StreamNode::TailGen()))
     {
     }
 
@@ -37,7 +105,7 @@ struct PROPTEST_API Stream
     bool isEmpty() const;
 
     template <typename T>
-    T head() const { return *static_pointer_cast<T>(headPtr); }
+    T head() const { return *static_cast<const T*>(node->head); }
 
     Stream tail() const;
 
@@ -57,9 +125,9 @@ struct PROPTEST_API Stream
         if (isEmpty()) {
             return Stream::empty();
         } else {
-            auto thisTailGen = tailGen;
-            return Stream((*transformerPtr)(head<T>()), [transformerPtr, thisTailGen]() -> Stream {
-                return (*thisTailGen)().transform(transformerPtr);
+            auto thisNode = node;
+            return Stream((*transformerPtr)(head<T>()), [transformerPtr, thisNode]() -> Stream {
+                return fromNode(thisNode).tail().transform(transformerPtr);
             });
         }
     }
@@ -80,7 +148,7 @@ struct PROPTEST_API Stream
             for (auto itr = iterator<T>(); itr.hasNext();) {
                 auto value = itr.next();
                 if ((*criteriaPtr)(value)) {
-                    auto tail = itr.stream;
+                    Stream tail = itr.stream;
                     return Stream{value, [criteriaPtr, tail]() { return tail.filter(criteriaPtr); }};
                 }
             }
@@ -92,8 +160,16 @@ struct PROPTEST_API Stream
 
     Stream take(int n) const;
 
-    shared_ptr<void> headPtr;
-    shared_ptr<function<Stream()>> tailGen;
+    /**
+     * @brief Returns the same stream, with each tail computed only once
+     * @details Walking the returned stream again reuses the elements already produced, instead of reevaluating the
+     * tail thunks. The elements stay alive as long as the head of the stream is referenced.
+     */
+    Stream memoize() const;
+
+    bool isMemoized() const;
+
+    shared_ptr<StreamNode> node;
 
     static Stream empty();
 
@@ -107,8 +183,33 @@ struct PROPTEST_API Stream
     {
         return Stream(a, [=]() -> Stream { return Stream(b); });
     }
+
+private:
+    static Stream fromNode(shared_ptr<StreamNode> node);
 };
 
+/**
+ * @brief Typed view of a `Stream` whose elements are of type T
+ * @details Shares the node layout with `Stream`, so converting between the two is free. Elements are accessed by
+ * reference instead of being copied out of the type-erased node.
+ */
+template <typename T>
+struct TypedStream : public Stream
+{
+    TypedStream() {}
+    TypedStream(const Stream& other) : Stream(other) {}
+
+    template <typename F>
+    TypedStream(const T& h, F&& gen) : Stream(h, util::forward<F>(gen))
+    {
+    }
+
+    explicit TypedStream(const T& h) : Stream(h) {}
+
+    const T& head() const { return *static_cast<const T*>(node->head); }
+
+    TypedStream<T> tail() const { return TypedStream<T>(Stream::tail()); }
+};
 
 template <typename T>
 struct Iterator
@@ -122,12 +223,12 @@ struct Iterator
         if (!hasNext()) {
             throw invalid_argument("iterator has no more next");
         }
-        T value = stream.head<T>();
+        T value = stream.head();
         stream = stream.tail();
         return value;
     }
 
-    Stream stream;
+    TypedStream<T> stream;
 };
 
 
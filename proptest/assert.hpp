@@ -48,12 +48,15 @@ PropertyFailed<ValueTuple>::~PropertyFailed()
 
 struct PROPTEST_API Discard : public logic_error
 {
-    Discard(const char* /*fname*/, int /*line*/, const error_code& /*error*/, const char* /*condition*/,
+    Discard(const char* fname, int line, const error_code& /*error*/, const char* /*condition*/,
             const void* /*caller*/)
-        : logic_error("Discard")
+        : logic_error("Discard"), filename(fname), lineno(line)
     {
     }
     virtual ~Discard();
+
+    const char* filename;
+    int lineno;
 };
 
 struct PROPTEST_API Success : public logic_error
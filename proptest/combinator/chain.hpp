@@ -3,6 +3,7 @@
 #include "../Shrinkable.hpp"
 #include "../Random.hpp"
 #include "../GenBase.hpp"
+#include "../util/genprofile.hpp"
 #include "../util/function_traits.hpp"
 #include "../util/std.hpp"
 
@@ -56,6 +57,7 @@ struct ChainFunctor {
         : gen1Ptr(_gen1Ptr), gen2genPtr(_gen2genPtr) {}
 
     Shrinkable<Chain<T, U>> operator()(Random& rand) {
+        GenProfileScope scope("chain");
         // generate T
         Shrinkable<T> shrinkableTs = (*gen1Ptr)(rand);
         using Intermediate = pair<T, Shrinkable<U>>;
@@ -3,6 +3,7 @@
 #include "../Shrinkable.hpp"
 #include "../Random.hpp"
 #include "../GenBase.hpp"
+#include "../util/genprofile.hpp"
 
 /**
  * @file dependency.hpp
@@ -51,6 +52,7 @@ struct DependencyFunctor
         : gen1Ptr(_gen1Ptr), gen2genPtr(_gen2genPtr) {}
 
     Shrinkable<pair<T, U>> operator()(Random& rand) {
+        GenProfileScope scope("dependency");
         // generate T
         Shrinkable<T> shrinkableT = (*gen1Ptr)(rand);
         using Intermediate = pair<T, Shrinkable<U>>;
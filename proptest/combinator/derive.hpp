@@ -3,6 +3,7 @@
 #include "../Shrinkable.hpp"
 #include "../Random.hpp"
 #include "../GenBase.hpp"
+#include "../util/genprofile.hpp"
 
 /**
  * @file derive.hpp
@@ -50,6 +51,7 @@ struct DeriveFunctor {
         : gen1Ptr(_gen1Ptr), gen2genPtr(_gen2genPtr) {}
 
     Shrinkable<U> operator()(Random& rand) {
+        GenProfileScope scope("flatMap");
         // generate T
         Shrinkable<T> shrinkableT = (*gen1Ptr)(rand);
         using Intermediate = pair<T, Shrinkable<U>>;
@@ -2,6 +2,7 @@
 #include "../util/std.hpp"
 #include "../Shrinkable.hpp"
 #include "../GenBase.hpp"
+#include "../util/genprofile.hpp"
 
 /**
  * @file filter.hpp
@@ -17,36 +18,26 @@ struct Generator;
 
 namespace util {
 
-template <typename T, typename Criteria>
-struct FilterCastFunctor
-{
-    FilterCastFunctor(const Criteria& _criteria) : criteria(_criteria) {}
-
-    bool operator()(const Any& a) {
-        return criteria(a.cast<T>());
-    }
-
-    Criteria criteria;
-};
-
 template <typename T>
 struct FilterFunctor
 {
-    FilterFunctor(shared_ptr<GenFunction<T>> _genPtr, shared_ptr<function<bool(const Any&)>> _criteriaPtr)
+    FilterFunctor(shared_ptr<GenFunction<T>> _genPtr, shared_ptr<function<bool(T&)>> _criteriaPtr)
         : genPtr(_genPtr), criteriaPtr(_criteriaPtr) {}
 
     Shrinkable<T> operator()(Random& rand) {
+        util::GenProfileScope scope("filter");
         // TODO: add some configurable termination criteria (e.g. maximum no. of attempts)
         while (true) {
             Shrinkable<T> shrinkable = (*genPtr)(rand);
             if ((*criteriaPtr)(shrinkable.getRef())) {
                 return shrinkable.filter(criteriaPtr, 1);  // 1: tolerance
             }
+            scope.reject();
         }
     }
 
     shared_ptr<GenFunction<T>> genPtr;
-    shared_ptr<function<bool(const Any&)>> criteriaPtr;
+    shared_ptr<function<bool(T&)>> criteriaPtr;
 };
 
 }
@@ -70,8 +61,7 @@ Generator<T> filter(GEN&& gen, Criteria&& criteria)
     static_assert(is_convertible_v<GEN&&, function<Shrinkable<T>(Random&)>>,
                   "Gen must be a GenFunction<T> or a callable of Random& -> Shrinkable<T>");
     auto genPtr = util::make_shared<GenFunction<T>>(util::forward<GEN>(gen));
-    auto criteriaPtr =
-        util::make_shared<function<bool(const Any&)>>(util::FilterCastFunctor<T, Criteria>(criteria));
+    auto criteriaPtr = util::make_shared<function<bool(T&)>>(util::forward<Criteria>(criteria));
     return Generator<T>(util::FilterFunctor<T>(genPtr, criteriaPtr));
 }
 
@@ -0,0 +1,65 @@
+#pragma once
+#include "../util/std.hpp"
+#include "../Shrinkable.hpp"
+#include "../GenBase.hpp"
+
+/**
+ * @file memoize.hpp
+ * @brief Generator combinator for memoizing the shrinks of generated values
+ */
+
+namespace proptest {
+
+template <typename GEN>
+decltype(auto) generator(GEN&& gen);
+template <typename T>
+struct Generator;
+
+namespace util {
+
+template <typename T>
+struct MemoizeFunctor
+{
+    MemoizeFunctor(shared_ptr<GenFunction<T>> _genPtr) : genPtr(_genPtr) {}
+
+    Shrinkable<T> operator()(Random& rand) { return (*genPtr)(rand).memoize(); }
+
+    shared_ptr<GenFunction<T>> genPtr;
+};
+
+}  // namespace util
+
+/**
+ * @ingroup Combinators
+ * @brief Generator combinator for memoizing the shrinks of the generated values
+ * @tparam T generated type
+ * @tparam GEN base generator for type T
+ * @details The shrink tree of each generated value is evaluated lazily as usual, but each node is evaluated only once
+ * and kept while the value is alive. Useful for generators with deep `flatMap` or `filter` chains, whose shrinks
+ * are otherwise recomputed whenever they are walked again.
+ * @code
+ * memoize<vector<int>>(vecGen.filter([](vector<int>& vec) { return !vec.empty(); }));
+ * @endcode
+ */
+template <typename T, typename GEN>
+Generator<T> memoize(GEN&& gen)
+{
+    static_assert(is_convertible_v<GEN&&, function<Shrinkable<T>(Random&)>>,
+                  "Gen must be a GenFunction<T> or a callable of Random& -> Shrinkable<T>");
+    auto genPtr = util::make_shared<GenFunction<T>>(util::forward<GEN>(gen));
+    return Generator<T>(util::MemoizeFunctor<T>(genPtr));
+}
+
+/**
+ * @ingroup Combinators
+ * @brief Generator combinator for memoizing the shrinks of the generated values
+ * @tparam GEN base generator for type T (deduced)
+ */
+template <typename GEN>
+Generator<typename invoke_result_t<GEN, Random&>::type> memoize(GEN&& gen)
+{
+    using T = typename invoke_result_t<GEN, Random&>::type;
+    return memoize<T, GEN>(util::forward<GEN>(gen));
+}
+
+}  // namespace proptest
@@ -4,6 +4,7 @@
 #include "../assert.hpp"
 #include "../gen.hpp"
 #include "../GenBase.hpp"
+#include "../util/genprofile.hpp"
 
 /**
  * @file oneof.hpp
@@ -82,6 +83,7 @@ decltype(auto) oneOfHelper(const shared_ptr<vector<util::Weighted<T>>>& genVecPt
         }
 
     return generator([genVecPtr](Random& rand) {
+        util::GenProfileScope scope("oneOf");
         while (true) {
             auto dice = rand.getRandomSize(0, genVecPtr->size());
             const util::Weighted<T>& weighted = (*genVecPtr)[dice];
@@ -92,6 +94,7 @@ decltype(auto) oneOfHelper(const shared_ptr<vector<util::Weighted<T>>>& genVecPt
                         return (*weighted.funcPtr)(rand);
                     } catch (const Discard&) {
                         // TODO: trace level low
+                        scope.reject();
                     }
                 }
             }
@@ -0,0 +1,70 @@
+#pragma once
+#include "../util/std.hpp"
+#include "../util/genprofile.hpp"
+#include "../Shrinkable.hpp"
+#include "../GenBase.hpp"
+
+/**
+ * @file profile.hpp
+ * @brief Generator combinator for naming a generator in the generation profile
+ */
+
+namespace proptest {
+
+template <typename GEN>
+decltype(auto) generator(GEN&& gen);
+template <typename T>
+struct Generator;
+
+namespace util {
+
+template <typename T>
+struct ProfileFunctor
+{
+    ProfileFunctor(const string& _name, shared_ptr<GenFunction<T>> _genPtr) : name(_name), genPtr(_genPtr) {}
+
+    Shrinkable<T> operator()(Random& rand)
+    {
+        GenProfileScope scope(name);
+        return (*genPtr)(rand);
+    }
+
+    string name;
+    shared_ptr<GenFunction<T>> genPtr;
+};
+
+}  // namespace util
+
+/**
+ * @ingroup Combinators
+ * @brief Generator combinator for attributing the cost of a generator to a named node of the generation profile
+ * @tparam T generated type
+ * @tparam GEN base generator for type T
+ * @details The generated values are the same. While profiling (see `Property::setGenProfile()`), the calls, time,
+ * allocations and rejections of the generator and of the ones it calls are recorded under `name`.
+ * @code
+ * profile<vector<int>>("sorted vector", vecGen.map([](vector<int>& vec) { ... }));
+ * @endcode
+ */
+template <typename T, typename GEN>
+Generator<T> profile(const string& name, GEN&& gen)
+{
+    static_assert(is_convertible_v<GEN&&, function<Shrinkable<T>(Random&)>>,
+                  "Gen must be a GenFunction<T> or a callable of Random& -> Shrinkable<T>");
+    auto genPtr = util::make_shared<GenFunction<T>>(util::forward<GEN>(gen));
+    return Generator<T>(util::ProfileFunctor<T>(name, genPtr));
+}
+
+/**
+ * @ingroup Combinators
+ * @brief Generator combinator for attributing the cost of a generator to a named node of the generation profile
+ * @tparam GEN base generator for type T (deduced)
+ */
+template <typename GEN>
+Generator<typename invoke_result_t<GEN, Random&>::type> profile(const string& name, GEN&& gen)
+{
+    using T = typename invoke_result_t<GEN, Random&>::type;
+    return profile<T, GEN>(name, util::forward<GEN>(gen));
+}
+
+}  // namespace proptest
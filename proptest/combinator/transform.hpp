@@ -3,6 +3,7 @@
 #include "../Random.hpp"
 #include "../Shrinkable.hpp"
 #include "../GenBase.hpp"
+#include "../util/genprofile.hpp"
 
 /**
  * @file transform.hpp
@@ -20,28 +21,18 @@ struct Generator;
 namespace util {
 
 template <typename T, typename U>
-struct TransformFunctor1 {
-    TransformFunctor1(function<U(T&)> _transformer) : transformer(_transformer) { }
-
-    Any operator()(const Any& a) {
-        return Any(transformer(a.cast<T>()));
-    }
-
-    function<U(T&)> transformer;
-};
-
-template <typename T, typename U>
-struct TransformFunctor2 {
-    TransformFunctor2(shared_ptr<GenFunction<T>> _genPtr, shared_ptr<function<Any(const Any&)>> _transformerPtr)
+struct TransformFunctor {
+    TransformFunctor(shared_ptr<GenFunction<T>> _genPtr, shared_ptr<function<U(T&)>> _transformerPtr)
         : genPtr(_genPtr), transformerPtr(_transformerPtr) {}
 
     Shrinkable<U> operator()(Random& rand) {
+        GenProfileScope scope("map");
         Shrinkable<T> shrinkable = (*genPtr)(rand);
         return shrinkable.template map<U>(transformerPtr);
     }
 
     shared_ptr<GenFunction<T>> genPtr;
-    shared_ptr<function<Any(const Any&)>> transformerPtr;
+    shared_ptr<function<U(T&)>> transformerPtr;
 };
 
 } // namespace util
@@ -57,9 +48,8 @@ template <typename T, typename U>
 Generator<U> transform(GenFunction<T> gen, function<U(T&)> transformer)
 {
     auto genPtr = util::make_shared<decltype(gen)>(gen);
-    auto transformerPtr =
-        util::make_shared<function<Any(const Any&)>>(util::TransformFunctor1<T, U>(transformer));
-    return generator(util::TransformFunctor2<T, U>(genPtr, transformerPtr));
+    auto transformerPtr = util::make_shared<decltype(transformer)>(transformer);
+    return generator(util::TransformFunctor<T, U>(genPtr, transformerPtr));
 }
 
 }  // namespace proptest
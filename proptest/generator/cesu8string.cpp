@@ -88,7 +88,7 @@ Shrinkable<CESU8String> Arbi<CESU8String>::operator()(Random& rand)
 
     // str.substr(0, positions[len]);
 
-    return shrinkStringLike<CESU8String>(str, minSize, len, positions);
+    return shrinkStringLike<CESU8String>(str, minSize, len, util::move(positions));
 }
 
 }  // namespace proptest
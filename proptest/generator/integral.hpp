@@ -34,21 +34,18 @@ struct SignedFunctor {
 
 } // namespace util
 
+/**
+ * @brief Creates a shrinkable for an integer value in [min, max], shrinking towards 0 or the bound nearest to 0
+ */
 template <typename T>
-Shrinkable<T> generateInteger(Random& rand, T min = numeric_limits<T>::min(), T max = numeric_limits<T>::max())
+Shrinkable<T> shrinkableInteger(T value, T min = numeric_limits<T>::min(), T max = numeric_limits<T>::max())
 {
-    T value = 0;
-    if (min == numeric_limits<T>::min() && max == numeric_limits<T>::max() && rand.getRandomBool()) {
-        uint32_t i = rand.getRandomSize(0, sizeof(Arbi<T>::boundaryValues) / sizeof(Arbi<T>::boundaryValues[0]));
-        value = Arbi<T>::boundaryValues[i];
-    } else if (numeric_limits<T>::min() < 0)
-        value = rand.getRandom<T>(min, max);
-    else
-        value = rand.getRandomU<T>(min, max);
-
     if (value < min || max < value)
         throw runtime_error("invalid range");
 
+    if (util::isValueOnly())
+        return make_shrinkable<T>(value);
+
     if (min >= 0)  // [3,5] -> [0,2] -> [3,5]
     {
         return util::binarySearchShrinkableU(static_cast<T>(value - min))
@@ -63,6 +60,43 @@ Shrinkable<T> generateInteger(Random& rand, T min = numeric_limits<T>::min(), T
     }
 }
 
+template <typename T>
+Shrinkable<T> generateInteger(Random& rand, T min = numeric_limits<T>::min(), T max = numeric_limits<T>::max())
+{
+    T value = 0;
+    if (min == numeric_limits<T>::min() && max == numeric_limits<T>::max() && rand.getRandomBool()) {
+        uint32_t i = rand.getRandomSize(0, sizeof(Arbi<T>::boundaryValues) / sizeof(Arbi<T>::boundaryValues[0]));
+        value = Arbi<T>::boundaryValues[i];
+    } else if (numeric_limits<T>::min() < 0)
+        value = rand.getRandom<T>(min, max);
+    else
+        value = rand.getRandomU<T>(min, max);
+
+    return shrinkableInteger<T>(value, min, max);
+}
+
+/**
+ * @brief Generates `size` integers in bulk, with the same distribution as calling `generateInteger` `size` times
+ * @details Values are drawn with `Random::fillBounded` instead of one call per value. Half of the values are picked
+ * from the boundary values of `Arbi<T>`, as in `generateInteger`
+ */
+template <typename T>
+vector<T> generateIntegers(Random& rand, size_t size)
+{
+    constexpr uint32_t numBoundaryValues = sizeof(Arbi<T>::boundaryValues) / sizeof(Arbi<T>::boundaryValues[0]);
+    vector<T> values(size);
+    rand.fillBounded<T>(values, numeric_limits<T>::min(), numeric_limits<T>::max());
+    // a pick in [numBoundaryValues, 2 * numBoundaryValues) replaces the value with a boundary value. Lower picks
+    // keep it, so that a zero choice replays as the value nearest to zero rather than the first boundary value
+    vector<uint32_t> picks(size);
+    rand.fillBounded<uint32_t>(picks, 0, numBoundaryValues * 2 - 1);
+    for (size_t i = 0; i < size; i++) {
+        if (picks[i] >= numBoundaryValues)
+            values[i] = Arbi<T>::boundaryValues[picks[i] - numBoundaryValues];
+    }
+    return values;
+}
+
 /**
  * @ingroup Generators
  * @brief Arbitrary for int8_t
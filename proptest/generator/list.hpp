@@ -26,15 +26,35 @@ public:
     static size_t defaultMinSize;
     static size_t defaultMaxSize;
 
-    Arbi() : ArbiContainer<List>(defaultMinSize, defaultMaxSize), elemGen(Arbi<T>()) {}
+    Arbi()
+        : ArbiContainer<List>(defaultMinSize, defaultMaxSize),
+          elemGen(Arbi<T>()),
+          shrinkStrategy(ListShrinkStrategy::FRONT_AND_MID)
+    {
+    }
 
     Arbi(Arbi<T>& _elemGen)
         : ArbiContainer<List>(defaultMinSize, defaultMaxSize),
-          elemGen([_elemGen](Random& rand) mutable -> Shrinkable<T> { return _elemGen(rand); })
+          elemGen([_elemGen](Random& rand) mutable -> Shrinkable<T> { return _elemGen(rand); }),
+          shrinkStrategy(ListShrinkStrategy::FRONT_AND_MID)
     {
     }
 
-    Arbi(GenFunction<T> _elemGen) : ArbiContainer<List>(defaultMinSize, defaultMaxSize), elemGen(_elemGen) {}
+    Arbi(GenFunction<T> _elemGen)
+        : ArbiContainer<List>(defaultMinSize, defaultMaxSize),
+          elemGen(_elemGen),
+          shrinkStrategy(ListShrinkStrategy::FRONT_AND_MID)
+    {
+    }
+
+    /**
+     * @brief Sets how elements are removed when shrinking (see `ListShrinkStrategy` for which suits which failures)
+     */
+    Arbi<List>& setShrinkStrategy(ListShrinkStrategy strategy)
+    {
+        shrinkStrategy = strategy;
+        return *this;
+    }
 
     using vector_t = vector<Shrinkable<T>>;
     using shrinkable_t = Shrinkable<vector_t>;
@@ -49,10 +69,11 @@ public:
         for (size_t i = 0; i < size; i++)
             shrinkVec->push_back(elemGen(rand));
 
-        return shrinkListLike<list, T>(shrinkVec, minSize);
+        return shrinkListLike<list, T>(shrinkVec, minSize, true, shrinkStrategy);
     }
     // FIXME: turn to shared_ptr
     GenFunction<T> elemGen;
+    ListShrinkStrategy shrinkStrategy;
 };
 
 template <typename T>
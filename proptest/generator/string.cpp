@@ -12,18 +12,19 @@ size_t Arbi<string>::defaultMaxSize = 200;
 
 // defaults to ascii characters
 Arbi<string>::Arbi()
-    : ArbiContainer<string>(defaultMinSize, defaultMaxSize), elemGen(interval<char>(0x1, 0x7f))
+    : ArbiContainer<string>(defaultMinSize, defaultMaxSize), elemGen(interval<char>(0x1, 0x7f)), defaultElemGen(true)
 {
 }
 
 Arbi<string>::Arbi(Arbi<char>& _elemGen)
     : ArbiContainer<string>(defaultMinSize, defaultMaxSize),
-      elemGen([_elemGen](Random& rand) mutable { return _elemGen(rand); })
+      elemGen([_elemGen](Random& rand) mutable { return _elemGen(rand); }),
+      defaultElemGen(false)
 {
 }
 
 Arbi<string>::Arbi(GenFunction<char> _elemGen)
-    : ArbiContainer<string>(defaultMinSize, defaultMaxSize), elemGen(_elemGen)
+    : ArbiContainer<string>(defaultMinSize, defaultMaxSize), elemGen(_elemGen), defaultElemGen(false)
 {
 }
 
@@ -31,8 +32,13 @@ Shrinkable<string> Arbi<string>::operator()(Random& rand)
 {
     size_t size = rand.getRandomSize(minSize, maxSize + 1);
     string str(size, ' ' /*, allocator()*/);
-    for (size_t i = 0; i < size; i++)
-        str[i] = elemGen(rand).get();
+    // default ascii characters are drawn in bulk, except in the mt19937_64 compatibility mode
+    if (defaultElemGen && rand.getEngineType() != Random::EngineType::MT19937_64)
+        rand.fillBounded<char>(str, 0x1, 0x7f);
+    else {
+        for (size_t i = 0; i < size; i++)
+            str[i] = elemGen(rand).get();
+    }
 
     return shrinkString(str, minSize);
 }
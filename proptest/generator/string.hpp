@@ -31,6 +31,9 @@ public:
     Shrinkable<string> operator()(Random& rand) override;
     // FIXME: turn to shared_ptr
     GenFunction<char> elemGen;
+
+private:
+    bool defaultElemGen;
 };
 
 }  // namespace proptest
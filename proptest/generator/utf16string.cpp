@@ -74,7 +74,7 @@ Shrinkable<UTF16BEString> Arbi<UTF16BEString>::operator()(Random& rand)
         str[i] = chars[i];
     }
 
-    return shrinkStringLike<UTF16BEString>(str, minSize, len, positions);
+    return shrinkStringLike<UTF16BEString>(str, minSize, len, util::move(positions));
 }
 
 size_t Arbi<UTF16LEString>::defaultMinSize = 0;
@@ -152,7 +152,7 @@ Shrinkable<UTF16LEString> Arbi<UTF16LEString>::operator()(Random& rand)
         str[i] = chars[i];
     }
 
-    return shrinkStringLike<UTF16LEString>(str, minSize, len, positions);
+    return shrinkStringLike<UTF16LEString>(str, minSize, len, util::move(positions));
 }
 
 }  // namespace proptest
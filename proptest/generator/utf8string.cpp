@@ -89,7 +89,7 @@ Shrinkable<UTF8String> Arbi<UTF8String>::operator()(Random& rand)
         str[i] = chars[i];
     }
 
-    return shrinkStringLike<UTF8String>(str, minSize, len, positions);
+    return shrinkStringLike<UTF8String>(str, minSize, len, util::move(positions));
 }
 
 }  // namespace proptest
@@ -5,84 +5,66 @@
 namespace proptest {
 namespace util {
 
-Shrinkable<int64_t> binarySearchShrinkable(int64_t value)
-{
-    using stream_t = Stream;
-    using genfunc_t = function<stream_t(int64_t, int64_t)>;
-
-    // given min, max, generate stream
-    static genfunc_t genpos = +[](int64_t min, int64_t max) {
-        int64_t mid = static_cast<int64_t>(min / 2 + max / 2 + ((min % 2 != 0 && max % 2 != 0) ? 1 : 0));
-
-        if (min + 1 >= max) {
-            return stream_t::empty();
-        } else if (min + 2 >= max) {
-            return stream_t(make_shrinkable_any<int64_t>(mid));
-        } else
-            return stream_t(make_shrinkable_any<int64_t>(mid).with([=]() { return genpos(min, mid); }),
-                            [=]() { return genpos(mid, max); });
-    };
+namespace {
 
-    static genfunc_t genneg = +[](int64_t min, int64_t max) {
-        int64_t mid = static_cast<int64_t>(min / 2 + max / 2 + ((min % 2 != 0 && max % 2 != 0) ? -1 : 0));
+template <typename T>
+Stream integerShrinksStream(IntegerShrinks<T> shrinks);
 
-        if (min + 1 >= max) {
-            return stream_t::empty();
-        } else if (min + 2 >= max) {
-            return stream_t(make_shrinkable_any<int64_t>(mid));
-        } else
-            return stream_t(make_shrinkable_any<int64_t>(mid).with([=]() { return genneg(mid, max); }),
-                            [=]() { return genneg(min, mid); });
-    };
+// a candidate holding its value and the function producing its shrinks in a single allocation
+template <typename T>
+struct IntegerNode
+{
+    T value;
+    function<Stream()> shrinks;
+};
 
-    return make_shrinkable<int64_t>(value).with([value]() {
-        if (value == 0)
-            return stream_t::empty();
-        else if (value > 0)
-            return stream_t(make_shrinkable_any<int64_t>(0)).concat(genpos(0, value));
-        else
-            return stream_t(make_shrinkable_any<int64_t>(0)).concat(genneg(value, 0));
-    });
+template <typename T, typename F>
+ShrinkableAny integerShrinkable(T value, F&& shrinks)
+{
+    auto node = util::make_shared_in_arena<IntegerNode<T>>();
+    node->value = value;
+    // captures of two integers are stored inline by function
+    node->shrinks = util::forward<F>(shrinks);
+    Any any;
+    any.ptr = shared_ptr<void>(node, &node->value);
+    return ShrinkableAny(any, shared_ptr<function<Stream()>>(node, &node->shrinks));
 }
 
-Shrinkable<uint64_t> binarySearchShrinkableU(uint64_t value)
+template <typename T>
+Stream integerShrinksStream(IntegerShrinks<T> shrinks)
 {
-    using stream_t = Stream;
-    using genfunc_t = function<stream_t(uint64_t, uint64_t)>;
-
-    // given min, max, generate stream
-    static genfunc_t genpos = +[](uint64_t min, uint64_t max) {
-        uint64_t mid = static_cast<uint64_t>(min / 2 + max / 2 + ((min % 2 != 0 && max % 2 != 0) ? 1 : 0));
+    if (!shrinks.hasNext())
+        return Stream::empty();
+    T passing = shrinks.passing;
+    T candidate = shrinks.next();
+    return Stream(integerShrinkable<T>(candidate,
+                                       [passing, candidate]() {
+                                           return integerShrinksStream<T>(IntegerShrinks<T>(passing, candidate));
+                                       }),
+                  [shrinks]() { return integerShrinksStream<T>(shrinks); });
+}
 
-        if (min + 1 >= max) {
-            return stream_t::empty();
-        } else if (min + 2 >= max) {
-            return stream_t(make_shrinkable_any<uint64_t>(mid));
-        } else
-            return stream_t(make_shrinkable_any<uint64_t>(mid).with([=]() { return genpos(min, mid); }),
-                            [=]() { return genpos(mid, max); });
-    };
+template <typename T>
+Shrinkable<T> integerRootShrinkable(T value)
+{
+    if (value == 0)
+        return make_shrinkable<T>(value);
+    return Shrinkable<T>(integerShrinkable<T>(value, [value]() {
+        return Stream(ShrinkableAny(make_shrinkable<T>(0)),
+                      [value]() { return integerShrinksStream<T>(IntegerShrinks<T>(0, value)); });
+    }));
+}
 
-    static genfunc_t genneg = +[](uint64_t min, uint64_t max) {
-        uint64_t mid = static_cast<uint64_t>(min / 2 + max / 2 + ((min % 2 != 0 && max % 2 != 0) ? -1 : 0));
+}  // namespace
 
-        if (min + 1 >= max) {
-            return stream_t::empty();
-        } else if (min + 2 >= max) {
-            return stream_t(make_shrinkable_any<uint64_t>(mid));
-        } else
-            return stream_t(make_shrinkable_any<uint64_t>(mid).with([=]() { return genneg(mid, max); }),
-                            [=]() { return genneg(min, mid); });
-    };
+Shrinkable<int64_t> binarySearchShrinkable(int64_t value)
+{
+    return integerRootShrinkable<int64_t>(value);
+}
 
-    return make_shrinkable<uint64_t>(value).with([value]() {
-        if (value == 0)
-            return stream_t::empty();
-        else if (value > 0)
-            return stream_t(make_shrinkable_any<uint64_t>(0)).concat(genpos(0, value));
-        else
-            return stream_t(make_shrinkable_any<uint64_t>(0)).concat(genneg(value, 0));
-    });
+Shrinkable<uint64_t> binarySearchShrinkableU(uint64_t value)
+{
+    return integerRootShrinkable<uint64_t>(value);
 }
 
 }  // namespace util
@@ -9,6 +9,45 @@ class Random;
 
 namespace util {
 
+/**
+ * @brief Shrink candidates of an integer found failing, computed arithmetically
+ * @details Between a bound found passing and the failing value, yields the midpoint, then the midpoint of the
+ * remaining half nearer to the failing value, and so on. The shrinks of a candidate are the candidates between the
+ * passing bound it was yielded with and itself. Holds two integers, and doesn't allocate.
+ * @tparam T int64_t or uint64_t
+ */
+template <typename T>
+struct IntegerShrinks
+{
+    IntegerShrinks(T _passing, T _failing) : passing(_passing), failing(_failing) {}
+
+    bool hasNext() const { return distance() > 1; }
+
+    // returns the next candidate, whose shrinks are IntegerShrinks(passing, candidate) with passing before the call
+    T next()
+    {
+        uint64_t half = distance() / 2;
+        T mid = failing > passing ? static_cast<T>(static_cast<uint64_t>(passing) + half)
+                                  : static_cast<T>(static_cast<uint64_t>(passing) - half);
+        passing = mid;
+        return mid;
+    }
+
+    uint64_t distance() const
+    {
+        return failing > passing ? static_cast<uint64_t>(failing) - static_cast<uint64_t>(passing)
+                                 : static_cast<uint64_t>(passing) - static_cast<uint64_t>(failing);
+    }
+
+    T passing;
+    T failing;
+};
+
+/**
+ * @brief Shrinkable of an integer shrinking towards 0, first to 0 and then by binary search (see `IntegerShrinks`)
+ * @details Each candidate is a single allocation holding the value and its shrinks, plus the stream node yielding
+ * it
+ */
 PROPTEST_API Shrinkable<int64_t> binarySearchShrinkable(int64_t value);
 PROPTEST_API Shrinkable<uint64_t> binarySearchShrinkableU(uint64_t value);
 
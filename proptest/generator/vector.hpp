@@ -5,6 +5,7 @@
 #include "../util/printing.hpp"
 #include "../shrinker/listlike.hpp"
 #include "util.hpp"
+#include "integral.hpp"
 #include "../util/std.hpp"
 
 /**
@@ -27,19 +28,43 @@ public:
     static size_t defaultMinSize;
     static size_t defaultMaxSize;
 
-    Arbi() : ArbiContainer<vector<T>>(defaultMinSize, defaultMaxSize), elemGen(Arbi<T>()) {}
+    Arbi()
+        : ArbiContainer<vector<T>>(defaultMinSize, defaultMaxSize),
+          elemGen(Arbi<T>()),
+          defaultElemGen(true),
+          shrinkStrategy(ListShrinkStrategy::FRONT_AND_MID)
+    {
+    }
 
     Arbi(Arbi<T>& _elemGen)
         : ArbiContainer<vector<T>>(defaultMinSize, defaultMaxSize),
-          elemGen([_elemGen](Random& rand) mutable -> Shrinkable<T> { return _elemGen(rand); })
+          elemGen([_elemGen](Random& rand) mutable -> Shrinkable<T> { return _elemGen(rand); }),
+          defaultElemGen(false),
+          shrinkStrategy(ListShrinkStrategy::FRONT_AND_MID)
     {
     }
 
-    Arbi(GenFunction<T> _elemGen) : ArbiContainer<vector<T>>(defaultMinSize, defaultMaxSize), elemGen(_elemGen) {}
+    Arbi(GenFunction<T> _elemGen)
+        : ArbiContainer<vector<T>>(defaultMinSize, defaultMaxSize),
+          elemGen(_elemGen),
+          defaultElemGen(false),
+          shrinkStrategy(ListShrinkStrategy::FRONT_AND_MID)
+    {
+    }
 
     Arbi<Vector> setElemGen(GenFunction<T> _elemGen)
     {
         elemGen = _elemGen;
+        defaultElemGen = false;
+        return *this;
+    }
+
+    /**
+     * @brief Sets how elements are removed when shrinking (see `ListShrinkStrategy` for which suits which failures)
+     */
+    Arbi<Vector>& setShrinkStrategy(ListShrinkStrategy strategy)
+    {
+        shrinkStrategy = strategy;
         return *this;
     }
 
@@ -48,16 +73,28 @@ public:
         size_t size = rand.getRandomSize(minSize, maxSize + 1);
         auto shrinkVec = util::make_shared<vector<ShrinkableAny>>();
         shrinkVec->reserve(size);
+        // integers from the default Arbi<T> are drawn in bulk, except in the mt19937_64 compatibility mode
+        if constexpr (is_integral_v<T> && !is_same_v<T, bool>) {
+            if (defaultElemGen && rand.getEngineType() != Random::EngineType::MT19937_64) {
+                if (util::isValueOnly())
+                    return make_shrinkable<vector<T>>(generateIntegers<T>(rand, size));
+                for (auto value : generateIntegers<T>(rand, size))
+                    shrinkVec->push_back(shrinkableInteger<T>(value));
+                return shrinkListLike<vector, T>(shrinkVec, minSize, true, shrinkStrategy);
+            }
+        }
         for (size_t i = 0; i < size; i++)
             shrinkVec->push_back(elemGen(rand));
 
-        auto result = shrinkListLike<vector, T>(shrinkVec, minSize);
+        auto result = shrinkListLike<vector, T>(shrinkVec, minSize, true, shrinkStrategy);
         return result;
     }
 
     // FIXME: turn to shared_ptr
 private:
     GenFunction<T> elemGen;
+    bool defaultElemGen;
+    ListShrinkStrategy shrinkStrategy;
 };
 
 template <typename T>
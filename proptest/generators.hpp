@@ -18,6 +18,8 @@
 #include "generator/shared_ptr.hpp"
 #include "generator/nullable.hpp"
 #include "combinator/filter.hpp"
+#include "combinator/memoize.hpp"
+#include "combinator/profile.hpp"
 #include "combinator/transform.hpp"
 #include "combinator/construct.hpp"
 #include "combinator/elementof.hpp"
@@ -4,52 +4,49 @@ namespace proptest {
 
 namespace util {
 
-VectorShrinker::stream_t VectorShrinker::shrinkBulk(const VectorShrinker::shrinkable_t& ancestor, size_t power, size_t offset)
-{
-    static function<stream_t(const shrinkable_t&, size_t, size_t, const shrinkable_t&, size_t, size_t,
-                                shared_ptr<vector<e_stream_t>>)>
-        genStream = +[](const shrinkable_t& _ancestor, size_t _power, size_t _offset, const shrinkable_t& parent,
-                        size_t frompos, size_t topos, shared_ptr<vector<e_stream_t>> elemStreams) -> stream_t {
-        const size_t size = topos - frompos;
-        if (size == 0)
-            return stream_t::empty();
+namespace {
 
-        if (elemStreams->size() != size)
-            throw runtime_error("element streams size error");
+// shrinks of the elements being shrunk, with their positions
+using ElementStreams = vector<pair<size_t, Stream>>;
 
-        shared_ptr<vector<e_stream_t>> newElemStreams = util::make_shared<vector<e_stream_t>>();
-        newElemStreams->reserve(size);
+}  // namespace
 
+VectorShrinker::stream_t VectorShrinker::shrinkBulk(const VectorShrinker::shrinkable_t& ancestor, size_t power, size_t offset)
+{
+    static function<stream_t(const shrinkable_t&, size_t, size_t, const shrinkable_t&, shared_ptr<ElementStreams>)>
+        genStream = +[](const shrinkable_t& _ancestor, size_t _power, size_t _offset, const shrinkable_t& parent,
+                        shared_ptr<ElementStreams> elemStreams) -> stream_t {
+        const shrinkable_vector_t& ancestorVec = _ancestor.getRef();
+        // only the elements being shrunk are replaced, the rest is shared with the parent
         shrinkable_vector_t newVec = parent.getRef();
-        shrinkable_vector_t& ancestorVec = _ancestor.getRef();
 
         if (newVec.size() != ancestorVec.size())
             throw runtime_error("list size error: " + to_string(newVec.size()) +
                                 " != " + to_string(ancestorVec.size()));
 
-        // shrink each element in frompos~topos, put parent if shrink no longer possible
+        // shrink each element, put ancestor's back if shrink no longer possible
+        auto newElemStreams = util::make_shared<ElementStreams>();
+        newElemStreams->reserve(elemStreams->size());
         bool nothingToDo = true;
 
-        for (size_t i = 0; i < elemStreams->size(); i++) {
-            if ((*elemStreams)[i].isEmpty()) {
-                newVec[i + frompos] = ShrinkableAny(ancestorVec[i + frompos]);
-                newElemStreams->push_back(e_stream_t::empty());  // [1] -> []
+        for (const auto& [pos, elemStream] : *elemStreams) {
+            if (elemStream.isEmpty()) {
+                newVec.set(pos, ancestorVec[pos]);  // [1] -> [], and no longer shrunk
             } else {
-                newVec[i + frompos] = (*elemStreams)[i].head<ShrinkableAny>();
-                newElemStreams->push_back((*elemStreams)[i].tail());  // [0,4,6,7] -> [4,6,7]
+                newVec.set(pos, elemStream.head<ShrinkableAny>());
+                newElemStreams->push_back(make_pair(pos, elemStream.tail()));  // [0,4,6,7] -> [4,6,7]
                 nothingToDo = false;
             }
         }
         if (nothingToDo)
             return stream_t::empty();
 
-        auto newShrinkable = make_shrinkable<shrinkable_vector_t>(newVec);
+        auto newShrinkable = make_shrinkable<shrinkable_vector_t>(util::move(newVec));
         newShrinkable = newShrinkable.with(
             [newShrinkable, _power, _offset]() -> stream_t { return shrinkBulk(newShrinkable, _power, _offset); });
         return stream_t(ShrinkableAny(newShrinkable),
-                        [_ancestor, _power, _offset, newShrinkable, frompos, topos, newElemStreams]() -> stream_t {
-                            return genStream(_ancestor, _power, _offset, newShrinkable, frompos, topos,
-                                                newElemStreams);
+                        [_ancestor, _power, _offset, newShrinkable, newElemStreams]() -> stream_t {
+                            return genStream(_ancestor, _power, _offset, newShrinkable, newElemStreams);
                         });
     };
 
@@ -67,23 +64,19 @@ VectorShrinker::stream_t VectorShrinker::shrinkBulk(const VectorShrinker::shrink
     if (topos < parentSize)
         throw runtime_error("topos error: " + to_string(topos) + " != " + to_string(parentSize));
 
-    const size_t size = topos - frompos;
-    shrinkable_vector_t& parentVec = ancestor.getRef();
-    shared_ptr<vector<e_stream_t>> elemStreams = util::make_shared<vector<e_stream_t>>();
-    elemStreams->reserve(size);
+    const shrinkable_vector_t& parentVec = ancestor.getRef();
+    auto elemStreams = util::make_shared<ElementStreams>();
 
-    bool nothingToDo = true;
     for (size_t i = frompos; i < topos; i++) {
         auto shrinks = parentVec[i].shrinks();
-        elemStreams->push_back(shrinks);
         if (!shrinks.isEmpty())
-            nothingToDo = false;
+            elemStreams->push_back(make_pair(i, shrinks));
     }
 
-    if (nothingToDo)
+    if (elemStreams->empty())
         return stream_t::empty();
 
-    return genStream(ancestor, power, offset, ancestor, frompos, topos, elemStreams);
+    return genStream(ancestor, power, offset, ancestor, elemStreams);
 }
 
 VectorShrinker::stream_t VectorShrinker::shrinkElementwise(const VectorShrinker::shrinkable_t& shrinkable, size_t power, size_t offset)
@@ -108,39 +101,37 @@ VectorShrinker::stream_t VectorShrinker::shrinkElementwise(const VectorShrinker:
     return newShrinkable.shrinks();
 }
 
-VectorShrinker::shrinkable_t VectorShrinker::shrinkMid(shared_ptr<vector<ShrinkableAny>> shrinkableCont, size_t minSize, size_t frontSize, size_t rearSize) {
+VectorShrinker::shrinkable_t VectorShrinker::shrinkMid(const shrinkable_vector_t& shrinkableCont, size_t minSize, size_t frontSize, size_t rearSize) {
     // remove mid as much as possible
     size_t minRearSize = minSize >= frontSize ? minSize - frontSize : 0;
-    size_t maxRearSize = shrinkableCont->size() - frontSize;
+    size_t maxRearSize = shrinkableCont.size() - frontSize;
     // rear size within [minRearSize, minRearSize]
     auto rangeShrinkable = util::binarySearchShrinkable(maxRearSize - minRearSize).template map<size_t>([minRearSize](const size_t& s) { return s + minRearSize; });
-    return rangeShrinkable.template flatMap<vector<ShrinkableAny>>([shrinkableCont, frontSize](const size_t& rearSize) {
+    return rangeShrinkable.template flatMap<shrinkable_vector_t>([shrinkableCont, frontSize](const size_t& rearSize) {
         // concat front and rear
-        auto cont = util::make_shared<Any>(util::make_any<vector<ShrinkableAny>>(shrinkableCont->begin(), shrinkableCont->begin() + frontSize));
-        auto& contRef = cont->cast<vector<ShrinkableAny>>();
-        contRef.insert(contRef.end(), shrinkableCont->begin() + (contRef.size()-rearSize), shrinkableCont->end());
-        return Shrinkable<vector<ShrinkableAny>>(cont);
+        shrinkable_vector_t cont = shrinkableCont.slice(0, frontSize);
+        cont.append(shrinkableCont.slice(shrinkableCont.size() - rearSize, shrinkableCont.size()));
+        return make_shrinkable<shrinkable_vector_t>(util::move(cont));
     }).concat([minSize, frontSize, rearSize](const shrinkable_t& parent) {
         size_t parentSize = parent.getRef().size();
         // no further shrinking possible
         if(parentSize <= minSize || parentSize <= frontSize)
             return Stream::empty();
-        return shrinkMid(parent.getSharedPtr(), minSize, frontSize + 1, rearSize).shrinks();
+        return shrinkMid(parent.getRef(), minSize, frontSize + 1, rearSize).shrinks();
     });
 }
 
-VectorShrinker::shrinkable_t VectorShrinker::shrinkFrontAndThenMid(shared_ptr<vector<ShrinkableAny>> shrinkableCont, size_t minSize, size_t rearSize) {
+VectorShrinker::shrinkable_t VectorShrinker::shrinkFrontAndThenMid(const shrinkable_vector_t& shrinkableCont, size_t minSize, size_t rearSize) {
     // remove front as much as possible
     size_t minFrontSize = minSize >= rearSize ? minSize - rearSize : 0;
-    size_t maxFrontSize = shrinkableCont->size() - rearSize;
+    size_t maxFrontSize = shrinkableCont.size() - rearSize;
     // front size within [min,max]
     auto rangeShrinkable = util::binarySearchShrinkable(maxFrontSize - minFrontSize).template map<size_t>([minFrontSize](const size_t& s) { return s + minFrontSize; });
-    return rangeShrinkable.template flatMap<vector<ShrinkableAny>>([shrinkableCont, maxFrontSize](const size_t& frontSize) {
+    return rangeShrinkable.template flatMap<shrinkable_vector_t>([shrinkableCont, maxFrontSize](const size_t& frontSize) {
         // concat front and rear
-        auto cont = util::make_shared<Any>(util::make_any<vector<ShrinkableAny>>(shrinkableCont->begin(), shrinkableCont->begin() + frontSize));
-        auto& contRef = cont->cast<vector<ShrinkableAny>>();
-        contRef.insert(contRef.end(), shrinkableCont->begin() + maxFrontSize, shrinkableCont->end());
-        return Shrinkable<vector<ShrinkableAny>>(cont);
+        shrinkable_vector_t cont = shrinkableCont.slice(0, frontSize);
+        cont.append(shrinkableCont.slice(maxFrontSize, shrinkableCont.size()));
+        return make_shrinkable<shrinkable_vector_t>(util::move(cont));
     }).concat([minSize, rearSize](const shrinkable_t& parent) {
         // reduce front [0,size-rearSize-1] as much possible
         size_t parentSize = parent.getRef().size();
@@ -148,7 +139,7 @@ VectorShrinker::shrinkable_t VectorShrinker::shrinkFrontAndThenMid(shared_ptr<ve
         if(parentSize <= minSize || parentSize <= rearSize) {
             // try shrinking mid
             if(minSize < parentSize && rearSize + 1 < parentSize)
-                return shrinkMid(parent.getSharedPtr(), minSize, 1, rearSize + 1).shrinks();
+                return shrinkMid(parent.getRef(), minSize, 1, rearSize + 1).shrinks();
             else
                 return Stream::empty();
         }
@@ -156,14 +147,64 @@ VectorShrinker::shrinkable_t VectorShrinker::shrinkFrontAndThenMid(shared_ptr<ve
         // [1,[2,3,4]]
         // [[1,2,3],4]
         // [[1,2],3,4]
-        return shrinkFrontAndThenMid(parent.getSharedPtr(), minSize, rearSize + 1).shrinks();
+        return shrinkFrontAndThenMid(parent.getRef(), minSize, rearSize + 1).shrinks();
+    });
+}
+
+VectorShrinker::shrinkable_t VectorShrinker::shrinkDDMin(const shrinkable_vector_t& shrinkableCont, size_t minSize, size_t granularity, size_t start) {
+    return make_shrinkable<shrinkable_vector_t>(shrinkableCont).with([shrinkableCont, minSize, granularity, start]() {
+        return shrinkDDMinStream(shrinkableCont, minSize, granularity, start, 0);
     });
 }
 
+VectorShrinker::stream_t VectorShrinker::shrinkDDMinStream(const shrinkable_vector_t& shrinkableCont, size_t minSize, size_t granularity, size_t start, size_t index) {
+    const size_t size = shrinkableCont.size();
+    if (size <= minSize)
+        return stream_t::empty();
+    const size_t numChunks = granularity < size ? granularity : size;
+    // candidates [0, numChunks): all but a chunk, from the `start`th chunk and wrapping around
+    // candidates [numChunks, 2*numChunks): a single chunk (same as a complement if there are two chunks, and as the
+    // list itself if there is one)
+    for (; index < 2 * numChunks; index++) {
+        bool isComplement = index < numChunks;
+        if (!isComplement && numChunks <= 2)
+            continue;
+        size_t chunk = isComplement ? (start + index) % numChunks : index - numChunks;
+        size_t frompos = size * chunk / numChunks;
+        size_t topos = size * (chunk + 1) / numChunks;
+        size_t newSize = isComplement ? size - (topos - frompos) : topos - frompos;
+        if (newSize < minSize)
+            continue;
+
+        shrinkable_vector_t newCont;
+        if (isComplement) {
+            newCont = shrinkableCont.slice(0, frompos);
+            newCont.append(shrinkableCont.slice(topos, size));
+        } else {
+            newCont = shrinkableCont.slice(frompos, topos);
+        }
+        // continue from a chunk with two halves, from a complement with one chunk less. The chunks before the
+        // removed one failed to be removed already, so they are retried last
+        size_t newGranularity = isComplement && numChunks > 3 ? numChunks - 1 : 2;
+        size_t newStart = isComplement && chunk < newGranularity ? chunk : 0;
+        return stream_t(ShrinkableAny(shrinkDDMin(newCont, minSize, newGranularity, newStart)),
+                        [shrinkableCont, minSize, numChunks, start, index]() {
+                            return shrinkDDMinStream(shrinkableCont, minSize, numChunks, start, index + 1);
+                        });
+    }
+    // no chunk could be removed: retry with smaller chunks, unless they are single elements already
+    if (numChunks < size)
+        return shrinkDDMinStream(shrinkableCont, minSize, numChunks * 2, 0, 0);
+    return stream_t::empty();
+}
+
 } // namespace util
 
-Shrinkable<vector<ShrinkableAny>> shrinkMembershipwise(const shared_ptr<vector<ShrinkableAny>>& shrinkableCont, size_t minSize) {
-    return util::VectorShrinker::shrinkFrontAndThenMid(shrinkableCont, minSize, 0);
+Shrinkable<util::PersistentVector<ShrinkableAny>> shrinkMembershipwise(const shared_ptr<vector<ShrinkableAny>>& shrinkableCont, size_t minSize, ListShrinkStrategy strategy) {
+    util::PersistentVector<ShrinkableAny> cont(shrinkableCont->begin(), shrinkableCont->end());
+    if (strategy == ListShrinkStrategy::DDMIN)
+        return util::VectorShrinker::shrinkDDMin(cont, minSize, 2);
+    return util::VectorShrinker::shrinkFrontAndThenMid(cont, minSize, 0);
 }
 
 } // namespace proptest
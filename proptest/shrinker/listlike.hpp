@@ -1,15 +1,29 @@
 #pragma once
 #include "../Shrinkable.hpp"
 #include "../util/std.hpp"
+#include "../util/persistentvector.hpp"
 #include "../generator/util.hpp"
 
 namespace proptest {
 
+/**
+ * @brief Strategy of membership-wise shrinking of list-like containers
+ *  * FRONT_AND_MID: removes the front and then the middle of the list, pinning one element at a time
+ *  * DDMIN: delta debugging, removes chunks of the list while halving the chunk size. Takes fewer steps when the
+ *    failure depends on a run of adjacent elements in a long list. FRONT_AND_MID does better when the elements are
+ *    spread across the list
+ */
+enum class ListShrinkStrategy { FRONT_AND_MID, DDMIN };
+
 namespace util {
 
+/**
+ * @brief Shrinking of lists of type-erased shrinkables
+ * @details Candidates are `PersistentVector`s, so a candidate shares the elements it has in common with its parent
+ */
 struct VectorShrinker
 {
-    using shrinkable_vector_t = vector<ShrinkableAny>;
+    using shrinkable_vector_t = PersistentVector<ShrinkableAny>;
     using shrinkable_t = Shrinkable<shrinkable_vector_t>;
     using stream_t = Stream;
     using e_stream_t = Stream;
@@ -18,16 +32,28 @@ struct VectorShrinker
 
     static stream_t shrinkElementwise(const shrinkable_t& shrinkable, size_t power, size_t offset);
 
-    static shrinkable_t shrinkMid(shared_ptr<vector<ShrinkableAny>> shrinkableCont, size_t minSize, size_t frontSize, size_t rearSize);
+    static shrinkable_t shrinkMid(const shrinkable_vector_t& shrinkableCont, size_t minSize, size_t frontSize, size_t rearSize);
+
+    static shrinkable_t shrinkFrontAndThenMid(const shrinkable_vector_t& shrinkableCont, size_t minSize, size_t rearSize);
 
-    static shrinkable_t shrinkFrontAndThenMid(shared_ptr<vector<ShrinkableAny>> shrinkableCont, size_t minSize, size_t rearSize);
+    /**
+     * @brief Delta debugging (ddmin) on the list split into `granularity` chunks
+     * @details Shrinks into each complement of a chunk, then into each chunk, then retries with twice the
+     * granularity, until single elements can't be removed anymore (a 1-minimal list). Complements are tried from
+     * the `start`th chunk, wrapping around, so that the chunks that failed to be removed before a removal are
+     * retried last rather than first
+     */
+    static shrinkable_t shrinkDDMin(const shrinkable_vector_t& shrinkableCont, size_t minSize, size_t granularity, size_t start = 0);
+
+    // shrinks of a list at the given granularity, starting from the `index`th candidate
+    static stream_t shrinkDDMinStream(const shrinkable_vector_t& shrinkableCont, size_t minSize, size_t granularity, size_t start, size_t index);
 
 };
 
 }  // namespace util
 
 
-PROPTEST_API Shrinkable<vector<ShrinkableAny>> shrinkMembershipwise(const shared_ptr<vector<ShrinkableAny>>& shrinkableCont, size_t minSize);
+PROPTEST_API Shrinkable<util::PersistentVector<ShrinkableAny>> shrinkMembershipwise(const shared_ptr<vector<ShrinkableAny>>& shrinkableCont, size_t minSize, ListShrinkStrategy strategy = ListShrinkStrategy::FRONT_AND_MID);
 
 /**
  * @brief Shrinking of a container (such as a set) using membership-wise shrinking
@@ -49,11 +75,11 @@ Shrinkable<Container<T>> shrinkContainer(const shared_ptr<Container<Shrinkable<T
         return shr;
     });
     // membershipwise shrinking
-    Shrinkable<vector<ShrinkableAny>> shrinkableElemsShr = shrinkMembershipwise(shrinkAnyVec, minSize);
+    Shrinkable<util::PersistentVector<ShrinkableAny>> shrinkableElemsShr = shrinkMembershipwise(shrinkAnyVec, minSize);
 
     // transform to proper output type
     return shrinkableElemsShr.template flatMap<Container<T>>(
-        +[](const vector<ShrinkableAny>& _shrinkableVector) -> Shrinkable<Container<T>> {
+        +[](const util::PersistentVector<ShrinkableAny>& _shrinkableVector) -> Shrinkable<Container<T>> {
             auto value = make_shrinkable<Container<T>>();
             Container<T>& valueCont = value.getRef();
             for(auto itr = _shrinkableVector.begin(); itr != _shrinkableVector.end(); ++itr) {
@@ -74,23 +100,33 @@ Shrinkable<Container<T>> shrinkContainer(const shared_ptr<Container<Shrinkable<T
  * @param shrinkableVector vector of Shrinkable<T>
  * @param minSize minimum size a shrunk list can be
  * @param elementwise whether to enable element-wise shrinking. If false, only membership-wise shrinking is performed
+ * @param strategy strategy of membership-wise shrinking
  * @return Shrinkable<ListLike<T>>
  */
 template <template <typename...> class ListLike, typename T>
-Shrinkable<ListLike<T>> shrinkListLike(const shared_ptr<vector<ShrinkableAny>>& shrinkAnyVec, size_t minSize, bool elementwise = true)
+Shrinkable<ListLike<T>> shrinkListLike(const shared_ptr<vector<ShrinkableAny>>& shrinkAnyVec, size_t minSize, bool elementwise = true,
+                                       ListShrinkStrategy strategy = ListShrinkStrategy::FRONT_AND_MID)
 {
+    if (util::isValueOnly()) {
+        auto value = make_shrinkable<ListLike<T>>();
+        ListLike<T>& valueVec = value.getRef();
+        for (const ShrinkableAny& shr : *shrinkAnyVec)
+            valueVec.push_back(shr.getAnyRef().cast<T>());
+        return value;
+    }
+
     // membershipwise shrinking
-    Shrinkable<vector<ShrinkableAny>> shrinkableElemsShr = shrinkMembershipwise(shrinkAnyVec, minSize);
+    Shrinkable<util::PersistentVector<ShrinkableAny>> shrinkableElemsShr = shrinkMembershipwise(shrinkAnyVec, minSize, strategy);
 
     // elementwise shrinking
     if(elementwise)
-        shrinkableElemsShr = shrinkableElemsShr.andThen(+[](const Shrinkable<vector<ShrinkableAny>>& parent) {
+        shrinkableElemsShr = shrinkableElemsShr.andThen(+[](const Shrinkable<util::PersistentVector<ShrinkableAny>>& parent) {
             return util::VectorShrinker::shrinkElementwise(parent, 0, 0);
         });
 
     // transform to proper output type
     return shrinkableElemsShr.template flatMap<ListLike<T>>(
-        +[](const vector<ShrinkableAny>& _shrinkAnyVec) -> Shrinkable<ListLike<T>> {
+        +[](const util::PersistentVector<ShrinkableAny>& _shrinkAnyVec) -> Shrinkable<ListLike<T>> {
             auto value = make_shrinkable<ListLike<T>>();
             ListLike<T>& valueVec = value.getRef();
             util::transform(
@@ -4,21 +4,26 @@
 namespace proptest {
 
 Shrinkable<string> shrinkString(const string& str, size_t minSize) {
+    if (util::isValueOnly())
+        return make_shrinkable<string>(str);
+
+    // candidates are substrings of one shared buffer, copied out only when their shrinkables are created
+    auto buffer = util::make_shared<const string>(str);
     size_t size = str.size();
     auto shrinkRear =
-        util::binarySearchShrinkableU(size - minSize).map<string>([str, minSize](const uint64_t& size) {
-            return str.substr(0, size + minSize);
+        util::binarySearchShrinkableU(size - minSize).map<string>([buffer, minSize](const uint64_t& size) {
+            return buffer->substr(0, size + minSize);
         });
 
     // shrink front
-    return shrinkRear.concat([minSize](const Shrinkable<string>& shr) {
-        auto& str = shr.getRef();
-        size_t maxSizeCopy = str.size();
+    return shrinkRear.concat([buffer, minSize](const Shrinkable<string>& shr) {
+        // shr is the prefix of the buffer with this size
+        size_t maxSizeCopy = shr.getRef().size();
         if (maxSizeCopy == minSize)
             return Stream::empty();
         auto newShrinkable = util::binarySearchShrinkableU(maxSizeCopy - minSize)
-                                 .map<string>([str, minSize = minSize, maxSizeCopy](const uint64_t& value) {
-                                     return str.substr(minSize + value, maxSizeCopy - (minSize + value));
+                                 .map<string>([buffer, minSize = minSize, maxSizeCopy](const uint64_t& value) {
+                                     return buffer->substr(minSize + value, maxSizeCopy - (minSize + value));
                                  });
         return newShrinkable.shrinks();
     });
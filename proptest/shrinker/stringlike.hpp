@@ -4,30 +4,45 @@
 
 namespace proptest {
 
+/**
+ * @brief Shrinking of strings of multi-byte characters, removing characters from the rear and then from the front
+ * @details Candidates are substrings of one shared copy of `str`, copied out only when their shrinkables are created,
+ * and the byte positions of the characters are held once for the whole shrink tree.
+ * @param str string to shrink
+ * @param minSize minimum number of characters
+ * @param size number of characters in str
+ * @param bytePositions byte positions of each character in str, followed by the end position
+ */
 template <typename StringLike>
-Shrinkable<StringLike> shrinkStringLike(const StringLike& str, size_t minSize, size_t size, const vector<int>& bytePositions) {
+Shrinkable<StringLike> shrinkStringLike(const StringLike& str, size_t minSize, size_t size, vector<int> bytePositions) {
+    if (util::isValueOnly())
+        return make_shrinkable<StringLike>(str);
+
+    auto buffer = util::make_shared<const StringLike>(str);
+    auto positions = util::make_shared<const vector<int>>(util::move(bytePositions));
+
     auto shrinkRear =
         util::binarySearchShrinkable(size - minSize)
-            .template map<StringLike>([str, minSize, bytePositions](const uint64_t& _size) -> StringLike {
-                if (bytePositions.empty())
+            .template map<StringLike>([buffer, minSize, positions](const uint64_t& _size) -> StringLike {
+                if (positions->empty())
                     return StringLike();
                 else
-                    return StringLike(str.substr(0, bytePositions[_size + minSize]));
+                    return StringLike(buffer->substr(0, (*positions)[_size + minSize]));
             });
 
-    return shrinkRear.concat([minSize, bytePositions](const Shrinkable<StringLike>& shr) {
-        auto& str = shr.getRef();
-        size_t maxSizeCopy = str.charsize();
+    return shrinkRear.concat([buffer, minSize, positions](const Shrinkable<StringLike>& shr) {
+        if (positions->empty())
+            return Stream::empty();
+        // shr is a prefix of the buffer, ending at the byte position of its number of characters
+        auto end = std::lower_bound(positions->begin(), positions->end(), static_cast<int>(shr.getRef().size()));
+        size_t maxSizeCopy = static_cast<size_t>(end - positions->begin());
         if (maxSizeCopy == minSize)
             return Stream::empty();
         auto newShrinkable =
             util::binarySearchShrinkableU(maxSizeCopy - minSize)
-                .map<StringLike>([str, minSize, maxSizeCopy, bytePositions](const uint64_t& value) {
-                    if (bytePositions.empty())
-                        return StringLike();
-                    else
-                        return StringLike(str.substr(bytePositions[minSize + value],
-                                                      bytePositions[maxSizeCopy] - bytePositions[minSize + value]));
+                .map<StringLike>([buffer, minSize, maxSizeCopy, positions](const uint64_t& value) {
+                    return StringLike(buffer->substr((*positions)[minSize + value],
+                                                     (*positions)[maxSizeCopy] - (*positions)[minSize + value]));
                 });
         return newShrinkable.shrinks();
     });
@@ -6,6 +6,7 @@
 #include "../Shrinkable.hpp"
 #include "../api.hpp"
 #include "../PropertyContext.hpp"
+#include "../RunStats.hpp"
 #include "../GenBase.hpp"
 #include "../util/std.hpp"
 #include <thread>
@@ -45,7 +46,10 @@ public:
           actionListGenPtr(_actionListGenPtr),
           seed(util::getGlobalSeed()),
           numRuns(defaultNumRuns),
-          maxDurationMs(0)
+          maxDurationMs(0),
+          maxDiscards(0),
+          maxDiscardRatio(DiscardLimit::defaultMaxDiscardRatio),
+          collectStats(false)
     {
     }
 
@@ -56,12 +60,16 @@ public:
           actionListGenPtr(_actionListGenPtr),
           seed(util::getGlobalSeed()),
           numRuns(defaultNumRuns),
-          maxDurationMs(0)
+          maxDurationMs(0),
+          maxDiscards(0),
+          maxDiscardRatio(DiscardLimit::defaultMaxDiscardRatio),
+          collectStats(false)
     {
     }
 
     bool go();
-    bool invoke(Random& rand);
+    // generates the inputs and runs them, setting the time taken by generation to `generationNanos` if given
+    bool invoke(Random& rand, uint64_t* generationNanos = nullptr);
     void handleShrink(Random& savedRand);
 
     Concurrency& setSeed(uint64_t s)
@@ -82,6 +90,38 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Sets the maximum number of discards across the runs, 0 for no limit (see `Property::setMaxDiscards()`)
+     */
+    Concurrency& setMaxDiscards(uint32_t discards)
+    {
+        maxDiscards = discards;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the maximum number of discards per run, 0 for no limit (see `Property::setMaxDiscardRatio()`)
+     */
+    Concurrency& setMaxDiscardRatio(double ratio)
+    {
+        if (ratio < 0.0)
+            throw invalid_argument("discard ratio must not be negative");
+        maxDiscardRatio = ratio;
+        return *this;
+    }
+
+    /**
+     * @brief Sets whether to time the phases of the runs, printed after the summary (see `Property::setStats()`)
+     */
+    Concurrency& setStats(bool enable)
+    {
+        collectStats = enable;
+        return *this;
+    }
+
+    // stats of the last go() with stats enabled
+    RunStats getStats() const { return stats; }
+
     Concurrency& setOnStartup(function<void()> onStartup) {
         onStartupPtr = util::make_shared<function<void()>>(onStartup);
         return *this;
@@ -117,6 +157,10 @@ private:
     uint64_t seed;
     uint32_t numRuns;
     uint32_t maxDurationMs;
+    uint32_t maxDiscards;
+    double maxDiscardRatio;
+    bool collectStats;
+    RunStats stats;
 };
 
 template <typename ActionType>
@@ -126,8 +170,21 @@ bool Concurrency<ActionType>::go()
     Random savedRand(seed);
     cout << "random seed: " << seed << endl;
     PropertyContext ctx;
+    DiscardLimit discardLimit(maxDiscards, maxDiscardRatio, numRuns);
+    stats = RunStats();
+    RunStats* runStats = collectStats ? &stats : nullptr;
     size_t i = 0;
     auto startedTime = steady_clock::now();
+    auto reportStats = [&]() {
+        if (!runStats)
+            return;
+        stats.runNanos =
+            static_cast<uint64_t>(duration_cast<util::nanoseconds>(steady_clock::now() - startedTime).count());
+        stats.print(cout);
+        cout << "stats json: ";
+        stats.printJson(cout);
+        cout << endl;
+    };
     try {
         for (; i < numRuns; i++) {
             if(maxDurationMs != 0) {
@@ -135,6 +192,7 @@ bool Concurrency<ActionType>::go()
                 if(duration_cast<util::milliseconds>(currentTime - startedTime).count() > maxDurationMs)
                 {
                     cout << "Timed out after " << duration_cast<util::milliseconds>(currentTime - startedTime).count() << "ms , passed " << i << " tests" << endl;
+                    reportStats();
                     return true;
                 }
             }
@@ -143,18 +201,41 @@ bool Concurrency<ActionType>::go()
                 pass = true;
                 try {
                     savedRand = rand;
-                    if(onStartupPtr)
+                    if(onStartupPtr) {
+                        util::PhaseTimer timer(runStats ? &runStats->startup : nullptr);
                         (*onStartupPtr)();
-                    if(invoke(rand) && onCleanupPtr)
+                    }
+                    bool invoked;
+                    {
+                        RunTimer timer(runStats);
+                        invoked = invoke(rand, timer.generationNanos());
+                    }
+                    if(invoked && onCleanupPtr) {
+                        util::PhaseTimer timer(runStats ? &runStats->cleanup : nullptr);
                         (*onCleanupPtr)();
+                    }
                     pass = true;
                 } catch (const Success&) {
                     pass = true;
-                } catch (const Discard&) {
-                    // silently discard combination
+                } catch (const Discard& e) {
+                    // discard combination, counting the discards of each site
                     pass = false;
+                    ctx.discard(e.filename, e.lineno);
+                    if (runStats) {
+                        runStats->numDiscards++;
+                        runStats->discardSites.add(e.filename, e.lineno);
+                    }
+                    if (!discardLimit.discarded()) {
+                        discardLimit.printGaveUp(cerr);
+                        ctx.printSummary();
+                        reportStats();
+                        return false;
+                    }
                 }
             } while (!pass);
+            discardLimit.decided();
+            if (runStats)
+                runStats->numRuns++;
         }
     } catch (const PropertyFailedBase& e) {
         cerr << "Falsifiable, after " << (i + 1) << " tests: " << e.what() << " (" << e.filename << ":" << e.lineno
@@ -162,16 +243,20 @@ bool Concurrency<ActionType>::go()
 
         // shrink
         handleShrink(savedRand);
+        reportStats();
         return false;
     } catch (const exception& e) {
         cerr << "Falsifiable, after " << (i + 1) << " tests - exception occurred: " << e.what() << endl;
         cerr << "    seed: " << seed << endl;
         // shrink
         handleShrink(savedRand);
+        reportStats();
         return false;
     }
 
     cout << "OK, passed " << numRuns << " tests" << endl;
+    ctx.printSummary();
+    reportStats();
 
     return true;
 }
@@ -221,14 +306,18 @@ struct RearRunner
 };
 
 template <typename ActionType>
-bool Concurrency<ActionType>::invoke(Random& rand)
+bool Concurrency<ActionType>::invoke(Random& rand, uint64_t* generationNanos)
 {
+    auto generationStart = steady_clock::now();
     Shrinkable<ObjectType> initialShr = (*initialGenPtr)(rand);
     ObjectType& obj = initialShr.getRef();
     ModelType model = modelFactoryPtr ? (*modelFactoryPtr)(obj) : ModelType();
     Shrinkable<ActionList> frontShr = (*actionListGenPtr)(rand);
     Shrinkable<ActionList> rear1Shr = (*actionListGenPtr)(rand);
     Shrinkable<ActionList> rear2Shr = (*actionListGenPtr)(rand);
+    if (generationNanos)
+        *generationNanos = static_cast<uint64_t>(
+            duration_cast<util::nanoseconds>(steady_clock::now() - generationStart).count());
     ActionList& front = frontShr.getRef();
     ActionList& rear1 = rear1Shr.getRef();
     ActionList& rear2 = rear2Shr.getRef();
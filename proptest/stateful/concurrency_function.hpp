@@ -6,6 +6,7 @@
 #include "../Shrinkable.hpp"
 #include "../api.hpp"
 #include "../PropertyContext.hpp"
+#include "../RunStats.hpp"
 #include "../GenBase.hpp"
 #include "../util/std.hpp"
 #include <thread>
@@ -44,7 +45,10 @@ public:
           seed(util::getGlobalSeed()),
           numRuns(defaultNumRuns),
           numThreads(defaultNumThreads),
-          maxDurationMs(0)
+          maxDurationMs(0),
+          maxDiscards(0),
+          maxDiscardRatio(DiscardLimit::defaultMaxDiscardRatio),
+          collectStats(false)
     {
     }
 
@@ -56,7 +60,10 @@ public:
           seed(util::getGlobalSeed()),
           numRuns(defaultNumRuns),
           numThreads(defaultNumThreads),
-          maxDurationMs(0)
+          maxDurationMs(0),
+          maxDiscards(0),
+          maxDiscardRatio(DiscardLimit::defaultMaxDiscardRatio),
+          collectStats(false)
     {
     }
 
@@ -86,7 +93,8 @@ public:
     }
 
     bool go();
-    bool invoke(Random& rand);
+    // generates the inputs and runs them, setting the time taken by generation to `generationNanos` if given
+    bool invoke(Random& rand, uint64_t* generationNanos = nullptr);
     void handleShrink(Random& savedRand);
 
     Concurrency& setSeed(uint64_t s)
@@ -113,6 +121,38 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Sets the maximum number of discards across the runs, 0 for no limit (see `Property::setMaxDiscards()`)
+     */
+    Concurrency& setMaxDiscards(uint32_t discards)
+    {
+        maxDiscards = discards;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the maximum number of discards per run, 0 for no limit (see `Property::setMaxDiscardRatio()`)
+     */
+    Concurrency& setMaxDiscardRatio(double ratio)
+    {
+        if (ratio < 0.0)
+            throw invalid_argument("discard ratio must not be negative");
+        maxDiscardRatio = ratio;
+        return *this;
+    }
+
+    /**
+     * @brief Sets whether to time the phases of the runs, printed after the summary (see `Property::setStats()`)
+     */
+    Concurrency& setStats(bool enable)
+    {
+        collectStats = enable;
+        return *this;
+    }
+
+    // stats of the last go() with stats enabled
+    RunStats getStats() const { return stats; }
+
 private:
     shared_ptr<ObjectTypeGen> initialGenPtr;
     shared_ptr<ModelTypeGen> modelFactoryPtr;
@@ -124,6 +164,10 @@ private:
     int numRuns;
     int numThreads;
     uint32_t maxDurationMs;
+    uint32_t maxDiscards;
+    double maxDiscardRatio;
+    bool collectStats;
+    RunStats stats;
 };
 
 template <typename ObjectType, typename ModelType>
@@ -133,8 +177,21 @@ bool Concurrency<ObjectType, ModelType>::go()
     Random savedRand(seed);
     cout << "random seed: " << seed << endl;
     PropertyContext ctx;
+    DiscardLimit discardLimit(maxDiscards, maxDiscardRatio, numRuns);
+    stats = RunStats();
+    RunStats* runStats = collectStats ? &stats : nullptr;
     int i = 0;
     auto startedTime = steady_clock::now();
+    auto reportStats = [&]() {
+        if (!runStats)
+            return;
+        stats.runNanos =
+            static_cast<uint64_t>(duration_cast<util::nanoseconds>(steady_clock::now() - startedTime).count());
+        stats.print(cout);
+        cout << "stats json: ";
+        stats.printJson(cout);
+        cout << endl;
+    };
     try {
         for (; i < numRuns; i++) {
             if(maxDurationMs != 0) {
@@ -142,6 +199,7 @@ bool Concurrency<ObjectType, ModelType>::go()
                 if(duration_cast<util::milliseconds>(currentTime - startedTime).count() > maxDurationMs)
                 {
                     cout << "Timed out after " << duration_cast<util::milliseconds>(currentTime - startedTime).count() << "ms , passed " << i << " tests" << endl;
+                    reportStats();
                     return true;
                 }
             }
@@ -150,19 +208,41 @@ bool Concurrency<ObjectType, ModelType>::go()
                 pass = true;
                 try {
                     savedRand = rand;
-                    if(onStartupPtr)
+                    if(onStartupPtr) {
+                        util::PhaseTimer timer(runStats ? &runStats->startup : nullptr);
                         (*onStartupPtr)();
-                    if(invoke(rand) && onCleanupPtr)
+                    }
+                    bool invoked;
+                    {
+                        RunTimer timer(runStats);
+                        invoked = invoke(rand, timer.generationNanos());
+                    }
+                    if(invoked && onCleanupPtr) {
+                        util::PhaseTimer timer(runStats ? &runStats->cleanup : nullptr);
                         (*onCleanupPtr)();
-
+                    }
                     pass = true;
                 } catch (const Success&) {
                     pass = true;
-                } catch (const Discard&) {
-                    // silently discard combination
+                } catch (const Discard& e) {
+                    // discard combination, counting the discards of each site
                     pass = false;
+                    ctx.discard(e.filename, e.lineno);
+                    if (runStats) {
+                        runStats->numDiscards++;
+                        runStats->discardSites.add(e.filename, e.lineno);
+                    }
+                    if (!discardLimit.discarded()) {
+                        discardLimit.printGaveUp(cerr);
+                        ctx.printSummary();
+                        reportStats();
+                        return false;
+                    }
                 }
             } while (!pass);
+            discardLimit.decided();
+            if (runStats)
+                runStats->numRuns++;
         }
     } catch (const PropertyFailedBase& e) {
         cerr << "Falsifiable, after " << (i + 1) << " tests: " << e.what() << " (" << e.filename << ":" << e.lineno
@@ -170,16 +250,20 @@ bool Concurrency<ObjectType, ModelType>::go()
         cerr << "    seed: " << seed << endl;
         // shrink
         handleShrink(savedRand);
+        reportStats();
         return false;
     } catch (const exception& e) {
         cerr << "Falsifiable, after " << (i + 1) << " tests - exception occurred: " << e.what() << endl;
         cerr << "    seed: " << seed << endl;
         // shrink
         handleShrink(savedRand);
+        reportStats();
         return false;
     }
 
     cout << "OK, passed " << numRuns << " tests" << endl;
+    ctx.printSummary();
+    reportStats();
 
     return true;
 }
@@ -227,10 +311,11 @@ struct RearRunner
 };
 
 template <typename ObjectType, typename ModelType>
-bool Concurrency<ObjectType, ModelType>::invoke(Random& rand)
+bool Concurrency<ObjectType, ModelType>::invoke(Random& rand, uint64_t* generationNanos)
 {
     constexpr int UNINITIALIZED_THREAD_ID = -2;
     constexpr int FRONT_THREAD_ID = -1;
+    auto generationStart = steady_clock::now();
     Shrinkable<ObjectType> initialShr = (*initialGenPtr)(rand);
 
     auto actionListGen = Arbi<list<Action<ObjectType,ModelType>>>(*actionGenPtr);
@@ -239,6 +324,9 @@ bool Concurrency<ObjectType, ModelType>::invoke(Random& rand)
     for (int i = 0; i < numThreads; i++) {
         rearShrs.push_back(actionListGen(rand));
     }
+    if (generationNanos)
+        *generationNanos = static_cast<uint64_t>(
+            duration_cast<util::nanoseconds>(steady_clock::now() - generationStart).count());
 
     ObjectType& obj = initialShr.getRef();
     ModelType model = modelFactoryPtr ? (*modelFactoryPtr)(obj) : ModelType();
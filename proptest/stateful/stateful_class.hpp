@@ -8,6 +8,8 @@
 #include "../Shrinkable.hpp"
 #include "../Random.hpp"
 #include "../GenBase.hpp"
+#include "../RunStats.hpp"
+#include "../util/genprofile.hpp"
 
 namespace proptest {
 
@@ -100,6 +102,22 @@ public:
         return *this;
     }
 
+    StatefulProperty& setStats(bool enable)
+    {
+        prop->setStats(enable);
+        return *this;
+    }
+
+    RunStats getStats() const { return prop->getStats(); }
+
+    StatefulProperty& setGenProfile(bool enable)
+    {
+        prop->setGenProfile(enable);
+        return *this;
+    }
+
+    shared_ptr<const util::GenProfile> getGenProfile() const { return prop->getGenProfile(); }
+
     bool go() { return prop->forAll(); }
 
 private:
@@ -9,6 +9,8 @@
 #include "../Shrinkable.hpp"
 #include "../Random.hpp"
 #include "../GenBase.hpp"
+#include "../RunStats.hpp"
+#include "../util/genprofile.hpp"
 #include "../combinator/just.hpp"
 
 namespace proptest {
@@ -34,7 +36,7 @@ class StatefulProperty {
 
 public:
     StatefulProperty(InitialGen&& initGen, ModelFactoryFunction mdlFactory, ActionGen<ObjectType, ModelType>& actGen)
-        : seed(UINT64_MAX), numRuns(UINT32_MAX), maxDurationMs(UINT32_MAX), initialGen(initGen), modelFactory(mdlFactory), actionGen(actGen)
+        : seed(UINT64_MAX), numRuns(UINT32_MAX), maxDurationMs(UINT32_MAX), collectStats(false), genProfiling(false), initialGen(initGen), modelFactory(mdlFactory), actionGen(actGen)
     {
     }
 
@@ -56,6 +58,24 @@ public:
         return *this;
     }
 
+    StatefulProperty& setStats(bool enable)
+    {
+        collectStats = enable;
+        return *this;
+    }
+
+    // stats of the last go() with stats enabled
+    RunStats getStats() const { return stats; }
+
+    StatefulProperty& setGenProfile(bool enable)
+    {
+        genProfiling = enable;
+        return *this;
+    }
+
+    // generation profile of the last go() with profiling enabled
+    shared_ptr<const util::GenProfile> getGenProfile() const { return genProfile; }
+
     StatefulProperty& setOnStartup(function<void()> onStartup)
     {
         onStartupPtr = util::make_shared<function<void()>>(onStartup);
@@ -118,13 +138,22 @@ public:
             prop->setNumRuns(numRuns);
         if (maxDurationMs != UINT32_MAX)
             prop->setMaxDurationMs(maxDurationMs);
-        return prop->forAll();
+        prop->setStats(collectStats).setGenProfile(genProfiling);
+        bool result = prop->forAll();
+        stats = prop->getStats();
+        if (genProfiling)
+            genProfile = prop->getGenProfile();
+        return result;
     }
 
 private:
     uint64_t seed;
     uint32_t numRuns;
     uint32_t maxDurationMs;
+    bool collectStats;
+    RunStats stats;
+    bool genProfiling;
+    shared_ptr<const util::GenProfile> genProfile;
     InitialGen initialGen;
     ModelFactoryFunction modelFactory;
     ActionGen<ObjectType, ModelType> actionGen;
@@ -103,3 +103,24 @@ TEST(ConcurrencyTest, bitmap)
         just<Bitmap>(Bitmap()), actionGen);
     prop.go();
 }
+
+TEST(ConcurrencyTest, MaxDiscards)
+{
+    // the actions run first, on the calling thread, always discard. The runs are given up instead of retried forever
+    int numCalls = 0;
+    auto discardingGen = just(SimpleAction<vector<int>>([&numCalls](vector<int>&) {
+        numCalls++;
+        PROP_DISCARD();
+    }));
+
+    auto prop = concurrency<vector<int>>(just(vector<int>()), discardingGen);
+    prop.setSeed(1).setMaxConcurrency(1).setNumRuns(20).setStats(true);
+    EXPECT_FALSE(prop.go());
+    // 10 discards per run by default, over the runs to make
+    EXPECT_EQ(numCalls, 201);
+    EXPECT_EQ(prop.getStats().numDiscards, 201U);
+
+    numCalls = 0;
+    EXPECT_FALSE(prop.setMaxDiscards(50).go());
+    EXPECT_EQ(numCalls, 51);
+}
@@ -43,6 +43,32 @@ TEST(PropTest, GenVectorOfInt)
         exhaustive(gen(rand), 0);
 }
 
+TEST(PropTest, GenVectorOfIntBulk)
+{
+    int64_t seed = getCurrentTime();
+    Random rand(seed);
+    Arbi<vector<int8_t>> gen;
+    gen.setSize(1000);
+
+    // values are drawn in bulk, still mixed with boundary values
+    auto shrinkable = gen(rand);
+    auto& vec = shrinkable.getRef();
+    ASSERT_EQ(vec.size(), 1000U);
+    EXPECT_NE(std::find(vec.begin(), vec.end(), INT8_MIN), vec.end());
+    EXPECT_NE(std::find(vec.begin(), vec.end(), INT8_MAX), vec.end());
+
+    Random rand2(seed);
+    EXPECT_EQ(gen(rand2).get(), vec);
+
+    Arbi<string> strGen;
+    strGen.setSize(1000);
+    string str = strGen(rand).get();
+    for (char c : str) {
+        EXPECT_GE(c, 0x1);
+        EXPECT_LE(c, 0x7f);
+    }
+}
+
 TEST(PropTest, GenVectorWithNoArbitrary)
 {
     int64_t seed = getCurrentTime();
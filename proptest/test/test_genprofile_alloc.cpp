@@ -0,0 +1,30 @@
+#include "testbase.hpp"
+
+using namespace proptest;
+
+// replaces the global `operator new` of this binary only, hence the separate test program
+PROPTEST_COUNT_ALLOCATIONS
+
+TEST(PropTest, GenProfileCountAllocations)
+{
+    auto vecGen = Arbi<vector<int>>().profile("int vector");
+    auto prop = property([](vector<int>, int) {});
+    prop.setGenProfile(true).setNumRuns(200);
+    EXPECT_TRUE(prop.forAll(vecGen, Arbi<int>()));
+    auto genProfile = prop.getGenProfile();
+    ASSERT_TRUE(genProfile);
+    const util::GenProfileNode& root = genProfile->root();
+
+    // the vectors are allocated on the heap, the ints are not
+    const util::GenProfileNode* vecNode = root.find("arg 0")->find("int vector");
+    ASSERT_TRUE(vecNode);
+    EXPECT_EQ(vecNode->calls, 200U);
+    EXPECT_GT(vecNode->allocations, 0U);
+    EXPECT_GE(vecNode->allocatedBytes, vecNode->allocations);
+    EXPECT_GE(root.find("arg 0")->allocations, vecNode->allocations);
+
+    // allocations outside of generation are not counted
+    auto allocations = vecNode->allocations;
+    vector<int> unrelated(1000);
+    EXPECT_EQ(vecNode->allocations, allocations);
+}
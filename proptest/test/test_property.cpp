@@ -1,4 +1,6 @@
 #include "testbase.hpp"
+#include <filesystem>
+#include <fstream>
 
 using namespace proptest;
 
@@ -380,3 +382,726 @@ TEST(StateTest, PropertyTimed)
 
     EXPECT_GE(duration_cast<util::milliseconds>(endTime - startTime).count(), 2000);
 }
+
+TEST(PropTest, PropertyParallel)
+{
+    std::atomic<int> numCalls{0};
+    auto prop = property([&numCalls](int value, vector<int> vec) {
+        numCalls++;
+        PROP_STAT(value > 0);
+        PROP_TAG("vector size > 5", vec.size() > 5);
+    });
+    EXPECT_TRUE(prop.setNumRuns(1000).setNumThreads(4).forAll());
+    EXPECT_EQ(numCalls.load(), 1000);
+
+    // failure is reported with the same run index and arguments regardless of the number of threads
+    mutex lastFailedMutex;
+    tuple<int, vector<int>> lastFailed;
+    auto failing = property([&lastFailedMutex, &lastFailed](int value, vector<int> vec) {
+        bool fails = value >= 9950 && vec.size() >= 3;
+        if (fails) {
+            lock_guard<mutex> lock(lastFailedMutex);
+            lastFailed = util::make_tuple(value, vec);
+        }
+        PROP_ASSERT(!fails);
+    });
+    auto valueGen = interval(0, 9999);
+    // shrinking takes a single step, so that the arguments reported keep the vector of the failed run
+    failing.setSeed(1).setMaxShrinkSteps(1);
+
+    // the first failing run, found by replaying the runs one by one
+    size_t failedIndex = 0;
+    while (failedIndex < 1000 && failing.setReplay(1, failedIndex).forAll(valueGen))
+        failedIndex++;
+    EXPECT_GT(failedIndex, 8U);
+    EXPECT_LT(failedIndex, 1000U);
+    auto replayed = lastFailed;
+    EXPECT_GE(get<1>(replayed).size(), 3U);
+
+    failing.clearReplay();
+    for (uint32_t numThreads : {1, 2, 4, 8}) {
+        lastFailed = util::make_tuple(0, vector<int>());
+        EXPECT_FALSE(failing.setNumThreads(numThreads).forAll(valueGen));
+        EXPECT_EQ(lastFailed, replayed);
+    }
+}
+
+TEST(PropTest, PropertyReplay)
+{
+    vector<int> values;
+    auto prop = property([&values](int value) {
+        values.push_back(value);
+    });
+    EXPECT_TRUE(prop.setSeed(1).setNumRuns(1000).forAll());
+    ASSERT_EQ(values.size(), 1000U);
+
+    // each run is regenerated from the seed and the run index alone
+    for (size_t index : {0, 1, 500, 999}) {
+        vector<int> recorded = values;
+        values.clear();
+        EXPECT_TRUE(prop.setReplay(1, index).forAll());
+        ASSERT_EQ(values.size(), 1U);
+        EXPECT_EQ(values[0], recorded[index]);
+        values = recorded;
+    }
+
+    auto failing = property([](int value) {
+        PROP_ASSERT(value < 1000);
+    });
+    EXPECT_FALSE(failing.setReplay(1, 0).forAll());
+
+    // all the runs are back after clearing
+    values.clear();
+    EXPECT_TRUE(prop.clearReplay().setNumRuns(1000).forAll());
+    EXPECT_EQ(values.size(), 1000U);
+
+    // runs share a single stream in compatibility mode
+    auto engineType = Random::getDefaultEngineType();
+    Random::setDefaultEngineType(Random::EngineType::MT19937_64);
+    EXPECT_THROW(prop.setReplay(1, 0), invalid_argument);
+    Random::setDefaultEngineType(engineType);
+    prop.setReplay(1, 0);
+    Random::setDefaultEngineType(Random::EngineType::MT19937_64);
+    EXPECT_THROW(prop.forAll(), invalid_argument);
+    Random::setDefaultEngineType(engineType);
+    prop.clearReplay();
+}
+
+TEST(PropTest, PropertyParallelShrink)
+{
+    // candidates evaluated in parallel may fail in any order, so the simplest failing args are kept
+    mutex simplestMutex;
+    tuple<vector<int>, int> simplest;
+    auto simpler = [](const tuple<vector<int>, int>& a, const tuple<vector<int>, int>& b) {
+        auto key = [](const tuple<vector<int>, int>& args) {
+            int64_t magnitude = 0;
+            for (int elem : get<0>(args))
+                magnitude += std::abs(static_cast<int64_t>(elem));
+            return util::make_tuple(get<0>(args).size(), magnitude, get<1>(args));
+        };
+        return key(a) < key(b);
+    };
+    auto prop = property([&](vector<int> vec, int value) {
+        bool fails = vec.size() >= 3 && value >= 100;
+        if (fails) {
+            lock_guard<mutex> lock(simplestMutex);
+            if (get<0>(simplest).empty() || simpler(util::make_tuple(vec, value), simplest))
+                simplest = util::make_tuple(vec, value);
+        }
+        PROP_ASSERT(!fails);
+    });
+    auto shrunk = [&](uint32_t numShrinkThreads) {
+        simplest = util::make_tuple(vector<int>(), 0);
+        EXPECT_FALSE(prop.setSeed(1).setNumShrinkThreads(numShrinkThreads).forAll());
+        return simplest;
+    };
+    auto sequential = shrunk(1);
+    EXPECT_EQ(get<0>(sequential).size(), 3U);
+    EXPECT_EQ(get<1>(sequential), 100);
+    // should find the same simplest args as the sequential shrinking
+    EXPECT_EQ(shrunk(4), sequential);
+}
+
+TEST(PropTest, PropertyArena)
+{
+    util::Arena& arena = util::Arena::forThisThread();
+    {
+        util::ArenaScope scope;
+        auto shr = make_shrinkable<int>(5);
+        Stream stream(1, []() { return Stream::one(2); });
+        EXPECT_EQ(util::currentMemoryResource(), &arena);
+        EXPECT_GT(arena.numLiveAllocations(), 0U);
+        // nodes are alive: memory is not returned
+        EXPECT_FALSE(arena.reset());
+    }
+    EXPECT_EQ(util::currentMemoryResource(), nullptr);
+    EXPECT_EQ(arena.numLiveAllocations(), 0U);
+
+    // a node kept beyond the scope stays valid
+    Shrinkable<string> kept = make_shrinkable<string>("x");
+    {
+        util::ArenaScope scope;
+        kept = make_shrinkable<string>("kept").map<string>([](const string& str) { return str + "!"; });
+    }
+    EXPECT_EQ(arena.numLiveAllocations(), 2U);
+    EXPECT_EQ(kept.get(), "kept!");
+    kept = make_shrinkable<string>("x");
+    EXPECT_EQ(arena.numLiveAllocations(), 0U);
+
+    auto prop = property([](vector<int> vec, string str) {
+        PROP_ASSERT(vec.size() < 5 || str.size() < 5);
+    });
+    EXPECT_FALSE(prop.setSeed(1).setUseArena(true).forAll());
+    EXPECT_FALSE(prop.setNumThreads(4).forAll());
+    EXPECT_EQ(arena.numLiveAllocations(), 0U);
+}
+
+TEST(PropTest, PropertyValueOnlyGeneration)
+{
+    // same values are generated without shrinks
+    auto gen = Arbi<vector<string>>();
+    Random rand1(1), rand2(1);
+    Shrinkable<vector<string>> full = gen(rand1);
+    Shrinkable<vector<string>> valueOnly = [&]() {
+        util::ValueOnlyScope scope;
+        return gen(rand2);
+    }();
+    EXPECT_EQ(full.get(), valueOnly.get());
+    EXPECT_TRUE(valueOnly.shrinks().isEmpty());
+    EXPECT_FALSE(util::isValueOnly());
+
+    // shrinking finds the same arguments either way
+    vector<pair<vector<int>, string>> lastArgs(2);
+    for (int i = 0; i < 2; i++) {
+        auto prop = property([&lastArgs, i](vector<int> vec, string str) {
+            lastArgs[i] = util::make_pair(vec, str);
+            PROP_ASSERT(vec.size() < 5 || str.size() < 5);
+        });
+        EXPECT_FALSE(prop.setSeed(1).setValueOnlyGeneration(i == 0).forAll());
+    }
+    EXPECT_EQ(lastArgs[0], lastArgs[1]);
+}
+
+TEST(PropTest, PropertyShrinkLimits)
+{
+    int numCalls = 0;
+    int lastFailed = 0;
+    auto prop = property([&numCalls, &lastFailed](int value) {
+        numCalls++;
+        if (value >= 100)
+            lastFailed = value;
+        PROP_ASSERT(value < 100);
+    });
+    auto gen = interval<int>(0, 2000000);
+
+    // unlimited
+    numCalls = 0;
+    EXPECT_FALSE(prop.setSeed(1).forAll(gen));
+    int numUnlimitedCalls = numCalls;
+    EXPECT_EQ(lastFailed, 100);
+    EXPECT_GT(numUnlimitedCalls, 10);
+
+    // first run fails, followed by limited number of evaluations
+    numCalls = 0;
+    EXPECT_FALSE(prop.setMaxShrinkEvaluations(5).forAll(gen));
+    EXPECT_EQ(numCalls, 1 + 5);
+    EXPECT_GT(lastFailed, 100);
+
+    numCalls = 0;
+    EXPECT_FALSE(prop.setMaxShrinkEvaluations(0).setMaxShrinkSteps(2).forAll(gen));
+    EXPECT_LT(numCalls, numUnlimitedCalls);
+    EXPECT_GT(lastFailed, 100);
+
+    numCalls = 0;
+    EXPECT_FALSE(prop.setMaxShrinkSteps(0).setMaxShrinkEvaluations(6).setNumShrinkThreads(4).forAll(gen));
+    EXPECT_EQ(numCalls, 1 + 6);
+
+    auto slowProp = property([&numCalls](int value) {
+        numCalls++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        PROP_ASSERT(value < 100);
+    });
+    numCalls = 0;
+    EXPECT_FALSE(slowProp.setSeed(1).setMaxShrinkDurationMs(12).forAll(gen));
+    // each evaluation takes at least 5ms, so shrinking stops after a few of them. Bounded by the unlimited count
+    // only, to leave room for slow machines
+    EXPECT_LT(numCalls, numUnlimitedCalls);
+}
+
+TEST(PropTest, PropertyShrinkCache)
+{
+    int numCalls = 0;
+    vector<bool> lastFailed;
+    auto prop = property([&numCalls, &lastFailed](vector<bool> vec) {
+        numCalls++;
+        bool failing = std::count(vec.begin(), vec.end(), true) >= 3;
+        if (failing)
+            lastFailed = vec;
+        PROP_ASSERT(!failing);
+    });
+
+    // duplicate candidates are skipped, with the same result
+    EXPECT_FALSE(prop.setSeed(3).setShrinkCacheSize(0).forAll());
+    int numUncachedCalls = numCalls;
+    vector<bool> uncachedResult = lastFailed;
+    numCalls = 0;
+    EXPECT_FALSE(prop.setShrinkCacheSize(1024).forAll());
+    EXPECT_LT(numCalls, numUncachedCalls);
+    EXPECT_EQ(lastFailed, uncachedResult);
+
+    // the last candidates of a shrink stream evaluated in parallel may all be cached, leaving an empty batch
+    // candidates evaluated in parallel may fail in any order, so the simplest failing vector is kept
+    mutex simplestMutex;
+    vector<bool> simplest;
+    auto counting = property([&simplestMutex, &simplest](vector<bool> vec) {
+        bool failing = std::count(vec.begin(), vec.end(), true) >= 3;
+        if (failing) {
+            lock_guard<mutex> lock(simplestMutex);
+            if (simplest.empty() || util::make_tuple(vec.size(), vec) < util::make_tuple(simplest.size(), simplest))
+                simplest = vec;
+        }
+        PROP_ASSERT(!failing);
+    });
+    auto shrunk = [&](uint32_t numShrinkThreads) {
+        simplest.clear();
+        EXPECT_FALSE(counting.setSeed(6).setShrinkCacheSize(1024).setNumShrinkThreads(numShrinkThreads).forAll());
+        return simplest;
+    };
+    vector<bool> sequential = shrunk(1);
+    EXPECT_EQ(sequential, vector<bool>(3, true));
+    EXPECT_EQ(shrunk(2), sequential);
+}
+
+TEST(PropTest, PropertyShrinkDDMin)
+{
+    int numCalls = 0;
+    vector<int> lastFailed;
+    auto prop = property([&numCalls, &lastFailed](vector<int> vec) {
+        numCalls++;
+        bool failing = std::count_if(vec.begin(), vec.end(), [](int value) { return value >= 990; }) >= 3;
+        if (failing)
+            lastFailed = vec;
+        PROP_ASSERT(!failing);
+    });
+
+    // the few failing elements are scattered in a long list
+    auto gen = Arbi<vector<int>>(interval(0, 1000)).setSize(1000).setMinSize(0).setShrinkStrategy(ListShrinkStrategy::DDMIN);
+    EXPECT_FALSE(prop.setSeed(1).setShrinkCacheSize(0).forAll(gen));
+    EXPECT_EQ(lastFailed.size(), 3U);
+    EXPECT_TRUE(std::all_of(lastFailed.begin(), lastFailed.end(), [](int value) { return value >= 990; }));
+    EXPECT_LT(numCalls, 200);
+
+    // a run of adjacent failing elements in a long list takes fewer evaluations to find than by removing the front
+    // and the middle, which searches for each of the elements in turn
+    int numCalls2 = 0;
+    auto runFailing = property([&numCalls2, &lastFailed](vector<int> vec) {
+        numCalls2++;
+        bool failing = std::count(vec.begin(), vec.end(), 1000) >= 8;
+        if (failing)
+            lastFailed = vec;
+        PROP_ASSERT(!failing);
+    });
+    auto withRun = [](ListShrinkStrategy strategy) {
+        return [strategy](Random&) {
+            auto elems = util::make_shared<vector<ShrinkableAny>>();
+            for (int i = 0; i < 1000; i++)
+                elems->push_back(ShrinkableAny(make_shrinkable<int>(i >= 300 && i < 308 ? 1000 : 0)));
+            return shrinkListLike<vector, int>(elems, 0, false, strategy);
+        };
+    };
+    EXPECT_FALSE(runFailing.forAll(withRun(ListShrinkStrategy::DDMIN)));
+    EXPECT_EQ(lastFailed, vector<int>(8, 1000));
+    int numDDMinCalls = numCalls2;
+    numCalls2 = 0;
+    EXPECT_FALSE(runFailing.forAll(withRun(ListShrinkStrategy::FRONT_AND_MID)));
+    EXPECT_EQ(lastFailed, vector<int>(8, 1000));
+    EXPECT_LT(numDDMinCalls, numCalls2);
+
+    // a single failing element is kept alone, without retrying it as its own chunk
+    auto anyFailing = property([&lastFailed](vector<int> vec) {
+        bool failing = std::any_of(vec.begin(), vec.end(), [](int value) { return value >= 990; });
+        if (failing)
+            lastFailed = vec;
+        PROP_ASSERT(!failing);
+    });
+    gen.setShrinkStrategy(ListShrinkStrategy::DDMIN);
+    EXPECT_FALSE(anyFailing.setSeed(1).forAll(gen));
+    EXPECT_EQ(lastFailed.size(), 1U);
+}
+
+TEST(PropTest, PropertyShrinkToFixpoint)
+{
+    tuple<int, int> lastFailed;
+    int numCalls = 0;
+    auto prop = property([&lastFailed, &numCalls](int a, int b) {
+        numCalls++;
+        if (a >= b)
+            lastFailed = util::make_tuple(a, b);
+        PROP_ASSERT(a < b);
+    });
+    auto gen = interval(0, 1000);
+
+    // a can't go below b while b is unshrunk, and is not shrunk again afterwards
+    EXPECT_FALSE(prop.setSeed(1).forAll(gen, gen));
+    EXPECT_EQ(get<1>(lastFailed), 0);
+    int onePass = get<0>(lastFailed);
+
+    EXPECT_FALSE(prop.setSeed(1).setShrinkToFixpoint(true).forAll(gen, gen));
+    EXPECT_EQ(get<1>(lastFailed), 0);
+    EXPECT_LT(get<0>(lastFailed), onePass);
+    // a is retried down to 0, rejected while b was unshrunk
+    EXPECT_EQ(lastFailed, util::make_tuple(0, 0));
+
+    // the shrink path stored leads to the same arguments, regenerated without shrinking again
+    string dir = (std::filesystem::temp_directory_path() / "proptest_fixpoint_test").string();
+    std::filesystem::remove_all(dir);
+    EXPECT_FALSE(prop.setName("fixpoint").setDatabase(dir).forAll(gen, gen));
+    lastFailed = util::make_tuple(-1, -1);
+    numCalls = 0;
+    EXPECT_FALSE(prop.forAll(gen, gen));
+    EXPECT_EQ(lastFailed, util::make_tuple(0, 0));
+    EXPECT_EQ(numCalls, 2);  // the failed run and its shrunk arguments
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PropTest, PropertyChoiceShrinking)
+{
+    vector<int> lastFailed;
+    int lastFailedCount = 0;
+    auto prop = property([&](int count, vector<int> vec) {
+        bool failing = std::count_if(vec.begin(), vec.end(), [](int value) { return value >= 50; }) >= 2;
+        if (failing) {
+            lastFailed = vec;
+            lastFailedCount = count;
+        }
+        PROP_ASSERT(!failing);
+    });
+    // the vector's size depends on a value generated before
+    auto vecGen = interval(2, 20).flatMap<vector<int>>([](int& size) {
+        auto gen = Arbi<vector<int>>(interval(0, 100));
+        gen.setSize(size);
+        return gen;
+    });
+
+    EXPECT_FALSE(prop.setSeed(1).setChoiceShrinking(true).forAll(interval(-1000, 1000), vecGen));
+    EXPECT_EQ(lastFailedCount, 0);
+    EXPECT_EQ(lastFailed, vector<int>({50, 50}));
+
+    // a generator throwing on the simplest choices makes an invalid candidate, not a failure
+    int lastFailedValue = -1;
+    auto throwing = property([&lastFailedValue](int a) {
+        if (a >= 10)
+            lastFailedValue = a;
+        PROP_ASSERT(a < 10);
+    });
+    auto throwingGen = interval(0, 1000).map<int>([](int& value) {
+        if (value == 0)
+            throw logic_error("zero");
+        return value;
+    });
+    EXPECT_FALSE(throwing.setSeed(1).setChoiceShrinking(true).forAll(throwingGen));
+    EXPECT_EQ(lastFailedValue, 10);
+}
+
+TEST(PropTest, PropertyFailureDatabase)
+{
+    string dir = (std::filesystem::temp_directory_path() / "proptest_failure_database_test").string();
+    std::filesystem::remove_all(dir);
+    int numCalls = 0;
+    tuple<int, int> lastFailed;
+    auto failing = property([&](int a, int b) {
+        numCalls++;
+        if (a + b >= 100)
+            lastFailed = util::make_tuple(a, b);
+        PROP_ASSERT(a + b < 100);
+    });
+    auto gen = interval(0, 1000);
+
+    EXPECT_FALSE(failing.setSeed(1).setName("PropTest.PropertyFailureDatabase").setDatabase(dir).forAll(gen, gen));
+    auto shrunk = lastFailed;
+    EXPECT_TRUE(std::filesystem::exists(FailureDatabase(dir).getPath("PropTest.PropertyFailureDatabase")));
+    auto stored = FailureDatabase(dir).load("PropTest.PropertyFailureDatabase");
+    ASSERT_EQ(stored.size(), 1U);
+    EXPECT_EQ(stored[0].seed, 1U);
+    EXPECT_FALSE(stored[0].shrinkPath.empty());
+
+    // an invalid record is skipped with its fields, the others are kept
+    string path = FailureDatabase(dir).getPath("PropTest.PropertyFailureDatabase");
+    string contents;
+    {
+        std::ifstream file(path);
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(path, ios::trunc);
+        file << "failure not-a-seed 0" << endl << "path 0:1" << endl << contents;
+    }
+    stored = FailureDatabase(dir).load("PropTest.PropertyFailureDatabase");
+    ASSERT_EQ(stored.size(), 1U);
+    EXPECT_EQ(stored[0].seed, 1U);
+
+    // the shrunk arguments are reported again from a different seed, without shrinking
+    numCalls = 0;
+    lastFailed = util::make_tuple(0, 0);
+    EXPECT_FALSE(failing.setSeed(2).forAll(gen, gen));
+    EXPECT_EQ(lastFailed, shrunk);
+    EXPECT_LE(numCalls, 2);
+
+    // the stored failure is removed once the property passes
+    auto fixed = property([](int a, int b) { PROP_ASSERT(a + b < 2000); });
+    EXPECT_TRUE(fixed.setSeed(2).setName("PropTest.PropertyFailureDatabase").setDatabase(dir).forAll(gen, gen));
+    EXPECT_TRUE(FailureDatabase(dir).load("PropTest.PropertyFailureDatabase").empty());
+    std::filesystem::remove_all(dir);
+
+    // a database that can't be written doesn't keep a failing property from reporting its shrunk arguments
+    std::filesystem::create_directories(dir);
+    std::filesystem::permissions(dir, std::filesystem::perms::owner_read | std::filesystem::perms::owner_exec);
+    string notADirectory = (std::filesystem::path(dir) / "file").string();
+    if (!std::ofstream(notADirectory)) {
+        // not writable, unless permissions are not enforced (e.g. for root)
+        for (const string& database : {(std::filesystem::path(dir) / "db").string(), dir}) {
+            lastFailed = util::make_tuple(0, 0);
+            EXPECT_FALSE(failing.setSeed(1).setDatabase(database).forAll(gen, gen));
+            EXPECT_EQ(lastFailed, shrunk);
+        }
+    }
+    std::filesystem::permissions(dir, std::filesystem::perms::owner_all);
+    // a file in the place of the directory
+    std::ofstream(notADirectory) << "not a directory" << endl;
+    lastFailed = util::make_tuple(0, 0);
+    EXPECT_FALSE(failing.setSeed(1).setDatabase(notADirectory).forAll(gen, gen));
+    EXPECT_EQ(lastFailed, shrunk);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(PropTest, PropertyCoverageGuided)
+{
+    // counters standing for instrumented code, one per matched digit of the sequence
+    static uint8_t counters[6];
+    size_t numCounters = util::Coverage::numCounters();
+    util::Coverage::registerCounters(counters, counters + 6);
+    EXPECT_EQ(util::Coverage::numCounters(), numCounters + 6);
+    auto prop = property([](int a, int b, int c, int d, int e, int f) {
+        int digits[] = {a, b, c, d, e, f};
+        int sequence[] = {3, 1, 4, 1, 5, 9};
+        for (size_t i = 0; i < 6; i++) {
+            if (digits[i] != sequence[i])
+                return true;
+            counters[i]++;
+        }
+        return false;
+    });
+    auto gen = interval(0, 9);
+
+    // one in a million inputs fails
+    EXPECT_TRUE(prop.setSeed(1).setNumRuns(50000).forAll(gen, gen, gen, gen, gen, gen));
+    // found by mutating the inputs that match longer prefixes of the sequence
+    string dir = (std::filesystem::temp_directory_path() / "proptest_coverage_guided_test").string();
+    std::filesystem::remove_all(dir);
+    prop.setName("PropTest.PropertyCoverageGuided").setDatabase(dir);
+    EXPECT_FALSE(prop.setSeed(1).setCoverageGuided(true).forAll(gen, gen, gen, gen, gen, gen));
+    auto stored = FailureDatabase(dir).load("PropTest.PropertyCoverageGuided");
+    ASSERT_EQ(stored.size(), 1U);
+    EXPECT_FALSE(stored[0].runChoices.empty());
+
+    // the mutated run is regenerated from its choices
+    EXPECT_FALSE(prop.setCoverageGuided(false).setNumRuns(1).forAll(gen, gen, gen, gen, gen, gen));
+    std::filesystem::remove_all(dir);
+
+    util::Coverage::unregisterCounters(counters, counters + 6);
+    EXPECT_EQ(util::Coverage::numCounters(), numCounters);
+}
+
+TEST(PropTest, PropertyFuzz)
+{
+    uint8_t bytes[] = {5, 0x88, 0x27, 0xff};
+    EXPECT_EQ(util::choicesFromBytes(bytes, sizeof(bytes)), (vector<uint64_t>{5, 5000, 0x7f}));
+
+    tuple<int, int> lastFailed;
+    auto prop = property([&](int a, int b) {
+        if (a >= 1000 && b >= 1000)
+            lastFailed = util::make_tuple(a, b);
+        PROP_ASSERT(a < 1000 || b < 1000);
+    });
+    auto gen = interval(0, 100000);
+
+    uint8_t passing[] = {5, 7};
+    EXPECT_TRUE(prop.fuzz(passing, sizeof(passing), gen, gen));
+    // inputs are drawn past the end of the bytes
+    auto inRange = property([](int a, int b) { PROP_ASSERT(a >= 0 && a <= 100000 && b >= 0 && b <= 100000); });
+    EXPECT_TRUE(inRange.fuzz(nullptr, 0, gen, gen));
+    EXPECT_TRUE(inRange.fuzz(bytes, sizeof(bytes), gen, gen));
+    // failures are shrunk
+    uint8_t failing[] = {0x88, 0x27, 0x88, 0x27};
+    EXPECT_FALSE(prop.fuzz(failing, sizeof(failing), gen, gen));
+    EXPECT_EQ(lastFailed, util::make_tuple(1000, 1000));
+}
+
+TEST(PropTest, PropertyTimeBudget)
+{
+    // a slow run sleeps for a tenth of the budget, so that the bounds hold on a loaded machine: the sleep only sets a
+    // lower bound of its cost, and without a budget the 1000 default runs would take 20s
+    int numFastRuns = 0;
+    int numSlowRuns = 0;
+    auto fast = property([&](int) { numFastRuns++; });
+    auto slow = property([&](int) {
+        numSlowRuns++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    });
+
+    auto startTime = steady_clock::now();
+    EXPECT_TRUE(fast.setTimeBudgetMs(200).forAll());
+    EXPECT_TRUE(slow.setTimeBudgetMs(200).forAll());
+    auto elapsedMs = duration_cast<util::milliseconds>(steady_clock::now() - startTime).count();
+    // the number of runs is set by the cost of a run
+    EXPECT_GT(numFastRuns, 100);
+    EXPECT_LE(numSlowRuns, 11);
+    EXPECT_GE(numSlowRuns, 1);
+    EXPECT_LT(elapsedMs, 5000);
+
+    // the budget of a suite is split across its properties
+    numFastRuns = 0;
+    numSlowRuns = 0;
+    PropertyBase::setSuiteTimeBudget(400, 2);
+    startTime = steady_clock::now();
+    EXPECT_TRUE(fast.setTimeBudgetMs(0).forAll());
+    EXPECT_TRUE(slow.setTimeBudgetMs(0).forAll());
+    elapsedMs = duration_cast<util::milliseconds>(steady_clock::now() - startTime).count();
+    EXPECT_GT(numFastRuns, 100);
+    EXPECT_LE(numSlowRuns, 21);
+    EXPECT_GE(numSlowRuns, 1);
+    EXPECT_LT(elapsedMs, 5000);
+
+    // once the suite's properties have run, the number of runs is used again
+    numFastRuns = 0;
+    EXPECT_TRUE(fast.setNumRuns(100).forAll());
+    EXPECT_EQ(numFastRuns, 100);
+}
+
+TEST(PropTest, PropertyStats)
+{
+    auto prop = property([](int a, int b) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        if (a % 4 == 0)
+            PROP_DISCARD();
+        PROP_EXPECT_EQ(a + b, b + a);
+    });
+    prop.setOnStartup([]() {}).setOnCleanup([]() {});
+    EXPECT_TRUE(prop.setNumRuns(200).setStats(true).forAll());
+    RunStats stats = prop.getStats();
+    EXPECT_EQ(stats.numRuns, 200U);
+    EXPECT_EQ(stats.generation.count(), 200U + stats.numDiscards);
+    EXPECT_EQ(stats.startup.count(), stats.generation.count());
+    // cleanup is skipped when the property function throws, as on a discard
+    EXPECT_EQ(stats.cleanup.count(), 200U);
+    EXPECT_GE(stats.property.percentile(0.5), 100000U);
+    EXPECT_LE(stats.property.percentile(0.5), stats.property.percentile(0.99));
+    EXPECT_LE(stats.property.percentile(0.99), stats.property.max());
+    EXPECT_GT(stats.runsPerSecond(), 0.0);
+    EXPECT_EQ(stats.numShrinkEvaluations, 0U);
+
+    stringstream json;
+    stats.printJson(json, "commutative");
+    EXPECT_EQ(json.str().find("{\"name\":\"commutative\",\"runs\":200,"), 0U);
+    // the stream prints numbers as before
+    stats.print(json);
+    EXPECT_EQ(json.precision(), stringstream().precision());
+
+    // shrinking is counted apart from the runs
+    auto failing = property([](int a) { PROP_ASSERT(a < 1000); });
+    EXPECT_FALSE(failing.setSeed(1).setStats(true).forAll());
+    stats = failing.getStats();
+    EXPECT_GT(stats.numShrinkEvaluations, 0U);
+    EXPECT_GT(stats.numShrinkSteps, 0U);
+    EXPECT_EQ(stats.shrinkEvaluation.count(), stats.numShrinkEvaluations);
+
+    // nothing is collected when disabled, the stats of the last run with stats are kept
+    EXPECT_TRUE(prop.setNumRuns(10).setStats(false).forAll());
+    EXPECT_EQ(prop.getStats().numRuns, 200U);
+}
+
+TEST(PropTest, PropertyGenProfile)
+{
+    auto evenGen = Arbi<int>().filter([](int& num) { return num % 2 == 0; });
+    // allocations are counted by the generator itself instead of by a global `operator new` replaced for the binary
+    auto vecGen = profile<vector<int>>("int vector", [](Random& rand) {
+        util::GenProfile::countAllocation(sizeof(int));
+        return Arbi<vector<int>>()(rand);
+    });
+    auto textGen = oneOf<string>(Arbi<string>(), just<string>("fixed")).map([](string& str) { return str + "!"; });
+
+    auto prop = property([](int, vector<int>, string) {});
+    prop.setGenProfile(true).setNumRuns(200);
+    EXPECT_TRUE(prop.forAll(evenGen, vecGen, textGen));
+    auto genProfile = prop.getGenProfile();
+    ASSERT_TRUE(genProfile);
+    const util::GenProfileNode& root = genProfile->root();
+    EXPECT_EQ(root.calls, 200U);
+    ASSERT_EQ(root.children.size(), 3U);
+
+    // each argument is a node, with the combinators it is built of below it
+    const util::GenProfileNode* arg0 = root.find("arg 0");
+    ASSERT_TRUE(arg0);
+    EXPECT_EQ(arg0->calls, 200U);
+    const util::GenProfileNode* filterNode = arg0->find("filter");
+    ASSERT_TRUE(filterNode);
+    EXPECT_EQ(filterNode->calls, 200U);
+    EXPECT_GT(filterNode->rejections, 0U);
+    EXPECT_LE(filterNode->nanos, arg0->nanos);
+
+    const util::GenProfileNode* vecNode = root.find("arg 1")->find("int vector");
+    ASSERT_TRUE(vecNode);
+    EXPECT_EQ(vecNode->calls, 200U);
+    EXPECT_EQ(vecNode->allocations, 200U);
+    EXPECT_EQ(vecNode->allocatedBytes, 200U * sizeof(int));
+    EXPECT_EQ(root.find("arg 1")->allocations, 200U);
+    EXPECT_EQ(root.find("arg 2")->allocations, 0U);
+
+    const util::GenProfileNode* mapNode = root.find("arg 2")->find("map");
+    ASSERT_TRUE(mapNode);
+    ASSERT_TRUE(mapNode->find("oneOf"));
+    EXPECT_EQ(mapNode->find("oneOf")->calls, 200U);
+    EXPECT_LE(mapNode->find("oneOf")->nanos, mapNode->nanos);
+
+    stringstream folded;
+    genProfile->printFolded(folded);
+    EXPECT_NE(folded.str().find("generation;arg 0;filter "), string::npos);
+    EXPECT_NE(folded.str().find("generation;arg 2;map;oneOf "), string::npos);
+
+    // nothing is recorded outside of a profiled run
+    EXPECT_EQ(util::GenProfile::current(), nullptr);
+    Random rand(1);
+    evenGen(rand);
+    EXPECT_EQ(filterNode->calls, 200U);
+}
+
+TEST(PropTest, PropertyMaxDiscards)
+{
+    // a precondition never met gives up instead of generating indefinitely
+    int numCalls = 0;
+    auto neverMet = property([&](int) {
+        numCalls++;
+        PROP_DISCARD();
+    });
+    EXPECT_FALSE(neverMet.setNumRuns(100).forAll());
+    EXPECT_EQ(numCalls, 1001);  // 10 discards per run by default
+
+    numCalls = 0;
+    EXPECT_FALSE(neverMet.setMaxDiscards(50).forAll());
+    EXPECT_EQ(numCalls, 51);
+
+    numCalls = 0;
+    EXPECT_FALSE(neverMet.setMaxDiscards(0).setMaxDiscardRatio(2).setNumThreads(4).forAll());
+    EXPECT_LE(numCalls, 201 + 4);
+    EXPECT_THROW(neverMet.setMaxDiscardRatio(-1), invalid_argument);
+
+    // discards within the limit are counted per site
+    const int line = __LINE__;
+    auto halfMet = property([](int a) {
+        if (a % 2 == 0)
+            PROP_DISCARD();
+        if (a % 3 == 0)
+            PROP_DISCARD();
+    });
+    EXPECT_TRUE(halfMet.setNumRuns(200).setStats(true).forAll());
+    const RunStats& stats = halfMet.getStats();
+    EXPECT_GT(stats.numDiscards, 200U);
+    EXPECT_EQ(stats.discardSites.total(), stats.numDiscards);
+    ASSERT_EQ(stats.discardSites.counts.size(), 2U);
+    uint64_t numEvenDiscards = stats.discardSites.counts.at(string(__FILE__) + ":" + to_string(line + 3));
+    uint64_t numMultipleOf3Discards = stats.discardSites.counts.at(string(__FILE__) + ":" + to_string(line + 5));
+    EXPECT_EQ(numEvenDiscards + numMultipleOf3Discards, stats.numDiscards);
+    // half of the inputs are even, a sixth are odd multiples of 3
+    EXPECT_GT(numEvenDiscards, numMultipleOf3Discards);
+    EXPECT_GT(numMultipleOf3Discards, 0U);
+
+    PropertyContext ctx;
+    ctx.discard("a.cpp", 1);
+    ctx.discard("a.cpp", 1);
+    ctx.discard("b.cpp", 2);
+    EXPECT_EQ(ctx.getDiscards().total(), 3U);
+    EXPECT_EQ(ctx.getDiscards().counts.at("a.cpp:1"), 2U);
+    stringstream sites;
+    ctx.getDiscards().print(sites);
+    EXPECT_LT(sites.str().find("a.cpp:1: 2/3"), sites.str().find("b.cpp:2: 1/3"));
+}
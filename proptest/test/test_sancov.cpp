@@ -0,0 +1,85 @@
+#include "googletest/googletest/include/gtest/gtest.h"
+#include "proptest/util/coverage.hpp"
+
+// the callbacks are defined by coverage.cpp, built into this test program with PROPTEST_SANCOV_CALLBACKS
+extern "C" {
+void __sanitizer_cov_8bit_counters_init(uint8_t* start, uint8_t* stop);
+void __sanitizer_cov_trace_pc_guard_init(uint32_t* start, uint32_t* stop);
+void __sanitizer_cov_trace_pc_guard(uint32_t* guard);
+}
+
+using namespace proptest;
+
+class SancovTestCase : public ::testing::Test {
+};
+
+TEST(SancovTestCase, TracePcGuard)
+{
+    ASSERT_EQ(util::Coverage::numCounters(), 0U);
+
+    // guards are numbered from 1, across modules
+    uint32_t guards1[3] = {};
+    __sanitizer_cov_trace_pc_guard_init(guards1, guards1 + 3);
+    EXPECT_EQ(guards1[0], 1U);
+    EXPECT_EQ(guards1[1], 2U);
+    EXPECT_EQ(guards1[2], 3U);
+    EXPECT_EQ(util::Coverage::numCounters(), 3U);
+
+    // a module initialized again keeps its numbers
+    __sanitizer_cov_trace_pc_guard_init(guards1, guards1 + 3);
+    EXPECT_EQ(guards1[2], 3U);
+    EXPECT_EQ(util::Coverage::numCounters(), 3U);
+
+    // the counters grow with the next module
+    uint32_t guards2[100] = {};
+    __sanitizer_cov_trace_pc_guard_init(guards2, guards2 + 100);
+    EXPECT_EQ(guards2[0], 4U);
+    EXPECT_EQ(guards2[99], 103U);
+    EXPECT_EQ(util::Coverage::numCounters(), 103U);
+    EXPECT_TRUE(util::Coverage::isAvailable());
+
+    util::Coverage coverage;
+    util::Coverage::reset();
+    __sanitizer_cov_trace_pc_guard(&guards1[1]);
+    __sanitizer_cov_trace_pc_guard(&guards2[99]);
+    EXPECT_EQ(coverage.update(), 2U);
+    util::Coverage::reset();
+    __sanitizer_cov_trace_pc_guard(&guards1[1]);
+    EXPECT_EQ(coverage.update(), 0U);
+
+    // a disabled guard is not counted
+    uint32_t disabled = 0;
+    __sanitizer_cov_trace_pc_guard(&disabled);
+    EXPECT_EQ(coverage.update(), 0U);
+
+    // hit counts saturate at 255, in the 128+ bucket, instead of wrapping around
+    util::Coverage::reset();
+    for (int i = 0; i < 300; i++)
+        __sanitizer_cov_trace_pc_guard(&guards1[0]);
+    EXPECT_EQ(coverage.update(), 1U);
+    util::Coverage::reset();
+    for (int i = 0; i < 200; i++)
+        __sanitizer_cov_trace_pc_guard(&guards1[0]);
+    EXPECT_EQ(coverage.update(), 0U);
+}
+
+TEST(SancovTestCase, Inline8bitCounters)
+{
+    size_t numCounters = util::Coverage::numCounters();
+    uint8_t counters[16] = {};
+    __sanitizer_cov_8bit_counters_init(counters, counters + 16);
+    EXPECT_EQ(util::Coverage::numCounters(), numCounters + 16);
+    // registered once per module
+    __sanitizer_cov_8bit_counters_init(counters, counters + 16);
+    EXPECT_EQ(util::Coverage::numCounters(), numCounters + 16);
+
+    util::Coverage coverage;
+    util::Coverage::reset();
+    counters[5] = 1;
+    EXPECT_EQ(coverage.update(), 1U);
+    util::Coverage::reset();
+    EXPECT_EQ(counters[5], 0U);
+
+    util::Coverage::unregisterCounters(counters, counters + 16);
+    EXPECT_EQ(util::Coverage::numCounters(), numCounters);
+}
@@ -1,4 +1,6 @@
 #include "testbase.hpp"
+#include "proptest/shrinker/string.hpp"
+#include "proptest/shrinker/stringlike.hpp"
 
 using namespace proptest;
 
@@ -22,3 +24,164 @@ TEST(PropTest, andThen)
         exhaustive(shr2, 0);
     }
 }
+
+TEST(PropTest, ShrinkableMemoize)
+{
+    int numCalls = 0;
+    auto countingMap = [&numCalls](const int& value) {
+        numCalls++;
+        return value * 2;
+    };
+    auto walk = [](const ShrinkableAny& shr, auto& self) -> int {
+        int count = 1;
+        for (auto itr = shr.shrinks().iterator<ShrinkableAny>(); itr.hasNext();)
+            count += self(itr.next(), self);
+        return count;
+    };
+
+    auto shr = util::binarySearchShrinkable(100).map<int>(countingMap);
+    int numNodes = walk(shr, walk);
+    EXPECT_EQ(numCalls, numNodes);
+    // the shrinks are recomputed on every walk, the root value is not
+    walk(shr, walk);
+    EXPECT_EQ(numCalls, numNodes * 2 - 1);
+
+    // each node is evaluated once, however many times the tree is walked
+    numCalls = 0;
+    auto memoized = util::binarySearchShrinkable(100).map<int>(countingMap).memoize();
+    EXPECT_EQ(walk(memoized, walk), numNodes);
+    walk(memoized, walk);
+    walk(memoized, walk);
+    EXPECT_EQ(numCalls, numNodes);
+
+    // memoize combinator
+    auto gen = memoize(interval<int>(0, 100));
+    Random rand(getCurrentTime());
+    auto generated = gen(rand);
+    EXPECT_EQ(walk(generated, walk), walk(generated, walk));
+}
+
+TEST(PropTest, ShrinkableTyped)
+{
+    // the value is stored in a single allocation shared by copies
+    auto shr = make_shrinkable<string>(3, 'a');
+    Shrinkable<string> copy = shr;
+    EXPECT_EQ(shr.getPtr(), copy.getPtr());
+    EXPECT_EQ(shr.getSharedPtr().use_count(), 3);
+    EXPECT_EQ(shr.get(), "aaa");
+
+    // typed map and filter are called with the value itself
+    const int64_t* seen = nullptr;
+    auto intShr = util::binarySearchShrinkable(10);
+    auto mapped = intShr.map<string>([&seen](const int64_t& value) {
+        seen = &value;
+        return to_string(value);
+    });
+    EXPECT_EQ(seen, intShr.getPtr());
+    EXPECT_EQ(mapped.getRef(), "10");
+
+    auto filtered = intShr.filter([](const int64_t& value) { return value % 2 == 0; });
+    for (auto itr = filtered.shrinks().iterator<Shrinkable<int64_t>>(); itr.hasNext();)
+        EXPECT_EQ(itr.next().get() % 2, 0);
+
+    auto flatMapped = intShr.flatMap<int64_t>([](const int64_t& value) { return make_shrinkable<int64_t>(value + 1); });
+    EXPECT_EQ(flatMapped.get(), 11);
+    EXPECT_EQ(flatMapped.shrinks().head<ShrinkableAny>().getAnyRef().cast<int64_t>(), 1);
+}
+
+namespace {
+
+// bytes of the candidates of a shrinkable of a string type
+template <typename T>
+vector<string> stringShrinks(const Shrinkable<T>& shr)
+{
+    vector<string> candidates;
+    for (auto itr = shr.shrinks().template iterator<Shrinkable<T>>(); itr.hasNext();)
+        candidates.push_back(static_cast<const string&>(itr.next().getRef()));
+    return candidates;
+}
+
+// candidates of the second level of the tree: shrinks of the first level candidate at `index`
+template <typename T>
+vector<string> stringShrinksOf(const Shrinkable<T>& shr, size_t index)
+{
+    auto itr = shr.shrinks().template iterator<Shrinkable<T>>();
+    for (size_t i = 0; i < index; i++)
+        itr.next();
+    return stringShrinks(itr.next());
+}
+
+}  // namespace
+
+TEST(PropTest, ShrinkString)
+{
+    // candidates removing characters from the rear, then from the front
+    util::ValueOnlyScope scope(false);
+    auto ascii = shrinkString("abcd", 0);
+    EXPECT_EQ(stringShrinks(ascii), vector<string>({"", "ab", "abc", "abcd", "cd", "d"}));
+    EXPECT_EQ(stringShrinksOf(ascii, 1), vector<string>({"a", "ab", "b"}));
+    EXPECT_EQ(stringShrinksOf(ascii, 2), vector<string>({"abc", "bc", "c"}));
+    EXPECT_EQ(stringShrinksOf(ascii, 4), vector<string>({"bcd"}));
+
+    auto asciiMin2 = shrinkString("abcd", 2);
+    EXPECT_EQ(stringShrinks(asciiMin2), vector<string>({"ab", "abc", "cd", "d"}));
+    EXPECT_EQ(stringShrinksOf(asciiMin2, 1), vector<string>({"c"}));
+    EXPECT_TRUE(stringShrinksOf(asciiMin2, 2).empty());
+}
+
+TEST(PropTest, ShrinkStringLike)
+{
+    // multi-byte characters are kept whole: 1 to 4 bytes in UTF-8
+    util::ValueOnlyScope scope(false);
+    UTF8String utf8("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+    auto utf8Shr = shrinkStringLike<UTF8String>(utf8, 0, 4, {0, 1, 3, 6, 10});
+    EXPECT_EQ(stringShrinks(utf8Shr),
+              vector<string>({"", "a\xC3\xA9", "a\xC3\xA9\xE2\x82\xAC", "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80",
+                              "\xE2\x82\xAC\xF0\x9F\x98\x80", "\xF0\x9F\x98\x80"}));
+    EXPECT_EQ(stringShrinksOf(utf8Shr, 1), vector<string>({"a", "a\xC3\xA9", "\xC3\xA9"}));
+    EXPECT_EQ(stringShrinksOf(utf8Shr, 2),
+              vector<string>({"a\xC3\xA9\xE2\x82\xAC", "\xC3\xA9\xE2\x82\xAC", "\xE2\x82\xAC"}));
+    EXPECT_EQ(stringShrinksOf(utf8Shr, 4), vector<string>({"\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"}));
+
+    auto utf8Min2 = shrinkStringLike<UTF8String>(utf8, 2, 4, {0, 1, 3, 6, 10});
+    EXPECT_EQ(stringShrinks(utf8Min2), vector<string>({"a\xC3\xA9", "a\xC3\xA9\xE2\x82\xAC",
+                                                       "\xE2\x82\xAC\xF0\x9F\x98\x80", "\xF0\x9F\x98\x80"}));
+    EXPECT_EQ(stringShrinksOf(utf8Min2, 1), vector<string>({"\xE2\x82\xAC"}));
+
+    // a surrogate pair in UTF-16, with the terminator the generator appends
+    UTF16BEString utf16(string("\x00\x61\x20\xAC\xD8\x3D\xDE\x00\x00\x62\x00\x00", 12));
+    auto utf16Shr = shrinkStringLike<UTF16BEString>(utf16, 0, 4, {0, 2, 4, 8, 10});
+    EXPECT_EQ(stringShrinks(utf16Shr),
+              vector<string>({"", string("\x00\x61\x20\xAC", 4), string("\x00\x61\x20\xAC\xD8\x3D\xDE\x00", 8),
+                              string("\x00\x61\x20\xAC\xD8\x3D\xDE\x00\x00\x62", 10),
+                              string("\xD8\x3D\xDE\x00\x00\x62", 6), string("\x00\x62", 2)}));
+    EXPECT_EQ(stringShrinksOf(utf16Shr, 1),
+              vector<string>({string("\x00\x61", 2), string("\x00\x61\x20\xAC", 4), "\x20\xAC"}));
+    EXPECT_EQ(stringShrinksOf(utf16Shr, 2), vector<string>({string("\x00\x61\x20\xAC\xD8\x3D\xDE\x00", 8),
+                                                            string("\x20\xAC\xD8\x3D\xDE\x00", 6),
+                                                            string("\xD8\x3D\xDE\x00", 4)}));
+    EXPECT_EQ(stringShrinksOf(utf16Shr, 4), vector<string>({string("\x20\xAC\xD8\x3D\xDE\x00\x00\x62", 8)}));
+
+    auto utf16Min2 = shrinkStringLike<UTF16BEString>(utf16, 2, 4, {0, 2, 4, 8, 10});
+    EXPECT_EQ(stringShrinks(utf16Min2),
+              vector<string>({string("\x00\x61\x20\xAC", 4), string("\x00\x61\x20\xAC\xD8\x3D\xDE\x00", 8),
+                              string("\xD8\x3D\xDE\x00\x00\x62", 6), string("\x00\x62", 2)}));
+    EXPECT_EQ(stringShrinksOf(utf16Min2, 1), vector<string>({string("\xD8\x3D\xDE\x00", 4)}));
+
+    // a supplementary character as two 3-byte surrogates in CESU-8
+    CESU8String cesu8("a\xC3\xA9\xED\xA0\xBD\xED\xB8\x80" "b");
+    auto cesu8Shr = shrinkStringLike<CESU8String>(cesu8, 0, 4, {0, 1, 3, 9, 10});
+    EXPECT_EQ(stringShrinks(cesu8Shr),
+              vector<string>({"", "a\xC3\xA9", "a\xC3\xA9\xED\xA0\xBD\xED\xB8\x80",
+                              "a\xC3\xA9\xED\xA0\xBD\xED\xB8\x80" "b", "\xED\xA0\xBD\xED\xB8\x80" "b", "b"}));
+    EXPECT_EQ(stringShrinksOf(cesu8Shr, 1), vector<string>({"a", "a\xC3\xA9", "\xC3\xA9"}));
+    EXPECT_EQ(stringShrinksOf(cesu8Shr, 2), vector<string>({"a\xC3\xA9\xED\xA0\xBD\xED\xB8\x80",
+                                                            "\xC3\xA9\xED\xA0\xBD\xED\xB8\x80",
+                                                            "\xED\xA0\xBD\xED\xB8\x80"}));
+    EXPECT_EQ(stringShrinksOf(cesu8Shr, 4), vector<string>({"\xC3\xA9\xED\xA0\xBD\xED\xB8\x80" "b"}));
+
+    auto cesu8Min2 = shrinkStringLike<CESU8String>(cesu8, 2, 4, {0, 1, 3, 9, 10});
+    EXPECT_EQ(stringShrinks(cesu8Min2), vector<string>({"a\xC3\xA9", "a\xC3\xA9\xED\xA0\xBD\xED\xB8\x80",
+                                                        "\xED\xA0\xBD\xED\xB8\x80" "b", "b"}));
+    EXPECT_EQ(stringShrinksOf(cesu8Min2, 1), vector<string>({"\xED\xA0\xBD\xED\xB8\x80"}));
+}
@@ -89,3 +89,89 @@ TEST(StreamTestCase, Stream)
         cout << "nonEmptyConcatEmpty:" << itr.next() << endl;
     }
 }
+
+TEST(StreamTestCase, TypedStream)
+{
+    static function<TypedStream<string>(int)> gen = [](int n) -> TypedStream<string> {
+        if (n == 0)
+            return Stream::empty();
+        return TypedStream<string>(to_string(n), [n]() { return gen(n - 1); });
+    };
+    TypedStream<string> stream = gen(3);
+
+    // typed and type-erased views share the nodes
+    Stream erased = stream;
+    EXPECT_EQ(&stream.head(), &erased.iterator<string>().stream.head());
+    EXPECT_EQ(stream.head(), "3");
+    EXPECT_EQ(stream.tail().head(), "2");
+    EXPECT_EQ(erased.tail().tail().head<string>(), "1");
+    EXPECT_TRUE(stream.tail().tail().tail().isEmpty());
+
+    // head is shared by concat and take
+    auto concatenated = stream.concat(Stream::one(string("0")));
+    EXPECT_EQ(&TypedStream<string>(concatenated).head(), &stream.head());
+    vector<string> values;
+    for (auto itr = concatenated.take(4).iterator<string>(); itr.hasNext();)
+        values.push_back(itr.next());
+    EXPECT_EQ(values, vector<string>({"3", "2", "1", "0"}));
+}
+
+TEST(StreamTestCase, SmallFunction)
+{
+    // small callables are stored inline, large ones on heap
+    auto counter = util::make_shared<int>(0);
+    util::SmallFunction<int(int)> small([counter](int n) { return (*counter += n); });
+    EXPECT_EQ(small(2), 2);
+    std::array<int64_t, 16> big{};
+    util::SmallFunction<int(int)> large([counter, big](int n) { return static_cast<int>(*counter += n + big[0]); });
+    EXPECT_EQ(large(3), 5);
+
+    util::SmallFunction<int(int)> moved(util::move(small));
+    EXPECT_FALSE(static_cast<bool>(small));
+    EXPECT_EQ(moved(1), 6);
+    moved = util::move(large);
+    EXPECT_EQ(moved(1), 7);
+    EXPECT_EQ(counter.use_count(), 2);
+    moved = util::SmallFunction<int(int)>();
+    EXPECT_EQ(counter.use_count(), 1);
+    EXPECT_THROW(moved(1), std::bad_function_call);
+}
+
+TEST(StreamTestCase, StreamMemoize)
+{
+    int numCalls = 0;
+    static function<Stream(int, int&)> gen = [](int n, int& calls) -> Stream {
+        calls++;
+        if (n == 0)
+            return Stream::empty();
+        return Stream(n, [n, &calls]() { return gen(n - 1, calls); });
+    };
+
+    auto walk = [](const Stream& stream) {
+        int sum = 0;
+        for (auto itr = stream.iterator<int>(); itr.hasNext();)
+            sum += itr.next();
+        return sum;
+    };
+
+    Stream stream = gen(10, numCalls);
+    EXPECT_EQ(walk(stream), 55);
+    EXPECT_EQ(walk(stream), 55);
+    EXPECT_EQ(numCalls, 21);
+
+    // tails are computed only once
+    numCalls = 0;
+    Stream memoized = gen(10, numCalls).memoize();
+    EXPECT_TRUE(memoized.isMemoized());
+    EXPECT_TRUE(memoized.tail().isMemoized());
+    EXPECT_EQ(walk(memoized), 55);
+    EXPECT_EQ(walk(memoized.take(5)), 40);
+    EXPECT_EQ(walk(memoized.concat(memoized)), 110);
+    EXPECT_EQ(numCalls, 11);
+    EXPECT_FALSE(stream.isMemoized());
+    EXPECT_FALSE(memoized.take(5).isMemoized());
+
+    // the memo is only carried by the nodes of memoized streams
+    EXPECT_EQ(sizeof(StreamNode), sizeof(void*) * 2 + sizeof(StreamNode::TailGen));
+    EXPECT_GT(sizeof(StreamNodeMemo), sizeof(StreamNodeRef));
+}
@@ -244,6 +244,79 @@ TEST(UtilTestCase, ShrinkableNumeric)
     }
 }
 
+TEST(UtilTestCase, IntegerShrinks)
+{
+    auto collect = [](auto shrinks) {
+        vector<int64_t> values;
+        while (shrinks.hasNext())
+            values.push_back(static_cast<int64_t>(shrinks.next()));
+        return values;
+    };
+    EXPECT_EQ(collect(util::IntegerShrinks<int64_t>(0, 10)), vector<int64_t>({5, 7, 8, 9}));
+    EXPECT_EQ(collect(util::IntegerShrinks<int64_t>(0, -10)), vector<int64_t>({-5, -7, -8, -9}));
+    EXPECT_EQ(collect(util::IntegerShrinks<int64_t>(5, 8)), vector<int64_t>({6, 7}));
+    EXPECT_EQ(collect(util::IntegerShrinks<uint64_t>(0, UINT64_MAX)).size(), 64U);
+    EXPECT_TRUE(collect(util::IntegerShrinks<int64_t>(INT64_MAX - 1, INT64_MAX)).empty());
+
+    // shrinks to 0 first, then by binary search, every value below visited once
+    auto shrinkable = util::binarySearchShrinkable(-100);
+    vector<int64_t> firstLevel;
+    for (auto itr = shrinkable.shrinks().iterator<Shrinkable<int64_t>>(); itr.hasNext();)
+        firstLevel.push_back(itr.next().get());
+    EXPECT_EQ(firstLevel, vector<int64_t>({0, -50, -75, -87, -93, -96, -98, -99}));
+
+    set<int64_t> visited;
+    function<void(const Shrinkable<uint64_t>&)> walk = [&](const Shrinkable<uint64_t>& shr) {
+        for (auto itr = shr.shrinks().iterator<Shrinkable<uint64_t>>(); itr.hasNext();) {
+            auto next = itr.next();
+            EXPECT_TRUE(visited.insert(static_cast<int64_t>(next.get())).second || next.get() == 0);
+            walk(next);
+        }
+    };
+    walk(util::binarySearchShrinkableU(100));
+    EXPECT_EQ(visited.size(), 100U);
+}
+
+TEST(UtilTestCase, PersistentVector)
+{
+    vector<int> values(100);
+    for (int i = 0; i < 100; i++)
+        values[i] = i;
+    util::PersistentVector<int> vec(values.begin(), values.end());
+    EXPECT_EQ(vec.size(), 100U);
+    EXPECT_EQ(vec.toVector(), values);
+
+    // copies are written without affecting the original
+    util::PersistentVector<int> copy = vec;
+    copy.set(40, -40);
+    copy.set(41, -41);
+    EXPECT_EQ(copy[40], -40);
+    EXPECT_EQ(copy[41], -41);
+    EXPECT_EQ(vec[40], 40);
+    EXPECT_EQ(vec.toVector(), values);
+
+    // front and rear joined, as in removing the middle of a list
+    util::PersistentVector<int> joined = vec.slice(0, 10);
+    joined.append(vec.slice(95, 100));
+    EXPECT_EQ(joined.toVector(), vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 95, 96, 97, 98, 99}));
+    joined.set(10, 0);
+    EXPECT_EQ(joined[10], 0);
+    EXPECT_EQ(vec[95], 95);
+    EXPECT_TRUE(vec.slice(50, 50).empty());
+    EXPECT_THROW(vec.slice(50, 101), invalid_argument);
+
+    // repeated slicing keeps matching a plain vector
+    util::PersistentVector<int> shrunk = vec;
+    vector<int> expected = values;
+    for (size_t i = 1; i + 1 < shrunk.size(); i++) {
+        util::PersistentVector<int> next = shrunk.slice(0, i);
+        next.append(shrunk.slice(i + 1, shrunk.size()));
+        shrunk = next;
+        expected.erase(expected.begin() + i);
+    }
+    EXPECT_EQ(shrunk.toVector(), expected);
+}
+
 TEST(UtilTestCase, ShrinkableString)
 {
     auto str = string("hello world");
@@ -357,6 +430,165 @@ TEST(UtilTestCase, RandomBasic)
     }
 }
 
+TEST(UtilTestCase, RandomSplitJump)
+{
+    int64_t seed = getCurrentTime();
+    Random rand(seed);
+    EXPECT_EQ(rand.getEngineType(), Random::EngineType::XOSHIRO256SS);
+
+    // split and jump are deterministic and leave copies in sync
+    Random rand2 = rand;
+    Random child = rand.split();
+    Random child2 = rand2.split();
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(child.getRandomUInt64(), child2.getRandomUInt64());
+        EXPECT_EQ(rand.getRandomUInt64(), rand2.getRandomUInt64());
+    }
+
+    Random jumped = rand;
+    jumped.jump();
+    rand2.jump();
+    for (int i = 0; i < 100; i++) {
+        auto value = jumped.getRandomUInt64();
+        EXPECT_EQ(value, rand2.getRandomUInt64());
+        EXPECT_NE(value, rand.getRandomUInt64());
+    }
+}
+
+TEST(UtilTestCase, RandomCompatEngine)
+{
+    int64_t seed = getCurrentTime();
+    Random rand(seed, Random::EngineType::MT19937_64);
+    EXPECT_EQ(rand.getEngineType(), Random::EngineType::MT19937_64);
+
+    // produces the same sequence as the previous mt19937_64 based implementation
+    mt19937_64 engine(seed);
+    uniform_int_distribution<uint64_t> dist;
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(rand.getRandomUInt64(), dist(engine));
+
+    Random copy = rand;
+    EXPECT_EQ(copy.getEngineType(), Random::EngineType::MT19937_64);
+    EXPECT_EQ(copy.getRandomInt32(), rand.getRandomInt32());
+    EXPECT_EQ(rand.split().getEngineType(), Random::EngineType::MT19937_64);
+    EXPECT_THROW(rand.jump(), runtime_error);
+}
+
+TEST(UtilTestCase, RandomForRun)
+{
+    // known answers of Philox4x32-10
+    uint32_t counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+    uint32_t key[2] = {0xa4093822, 0x299f31d0};
+    uint32_t out[4];
+    util::Philox4x32::block(counter, key, out);
+    EXPECT_EQ(out[0], 0xd16cfe09U);
+    EXPECT_EQ(out[1], 0x94fdccebU);
+    EXPECT_EQ(out[2], 0x5001e420U);
+    EXPECT_EQ(out[3], 0x24126ea1U);
+
+    int64_t seed = getCurrentTime();
+    Random rand = Random::forRun(seed, 12345);
+    EXPECT_EQ(rand.getEngineType(), Random::EngineType::PHILOX4X32);
+    Random rand2 = Random::forRun(seed, 12345);
+    Random other = Random::forRun(seed, 12346);
+    bool differs = false;
+    for (int i = 0; i < 100; i++) {
+        auto value = rand.getRandomUInt64();
+        EXPECT_EQ(value, rand2.getRandomUInt64());
+        differs = differs || value != other.getRandomUInt64();
+    }
+    EXPECT_TRUE(differs);
+}
+
+TEST(UtilTestCase, RandomFillBounded)
+{
+    int64_t seed = getCurrentTime();
+    Random rand(seed);
+
+    vector<int32_t> values(1000);
+    rand.fillBounded<int32_t>(values, -5, 5);
+    bool minFound = false, maxFound = false;
+    for (auto value : values) {
+        EXPECT_GE(value, -5);
+        EXPECT_LE(value, 5);
+        minFound = minFound || value == -5;
+        maxFound = maxFound || value == 5;
+    }
+    EXPECT_TRUE(minFound);
+    EXPECT_TRUE(maxFound);
+
+    vector<uint64_t> fullRange(100);
+    rand.fillBounded<uint64_t>(fullRange, 0, UINT64_MAX);
+    vector<uint64_t> single(100);
+    rand.fillBounded<uint64_t>(single, 42, 42);
+    for (auto value : single)
+        EXPECT_EQ(value, 42U);
+    EXPECT_THROW(rand.fillBounded<int32_t>(values, 1, 0), invalid_argument);
+
+    // deterministic for the same seed
+    Random rand1(seed), rand2(seed);
+    vector<uint64_t> raw1(100), raw2(100);
+    rand1.fillUInt64(raw1);
+    rand2.fillUInt64(raw2);
+    EXPECT_EQ(raw1, raw2);
+
+    uint64_t lo;
+    EXPECT_EQ(util::mulHiLo64(UINT64_MAX, UINT64_MAX, lo), UINT64_MAX - 1);
+    EXPECT_EQ(lo, 1U);
+}
+
+TEST(UtilTestCase, RandomChoices)
+{
+    // choices count from the value nearest to 0
+    EXPECT_EQ(util::signedToChoice(0, -2, 5), 0U);
+    EXPECT_EQ(util::signedToChoice(1, -2, 5), 1U);
+    EXPECT_EQ(util::signedToChoice(-1, -2, 5), 2U);
+    EXPECT_EQ(util::signedToChoice(3, -2, 5), 5U);
+    EXPECT_EQ(util::signedToChoice(-3, -5, -3), 0U);
+    for (int64_t value = -2; value <= 5; value++)
+        EXPECT_EQ(util::choiceToSigned(util::signedToChoice(value, -2, 5), -2, 5), value);
+    EXPECT_EQ(util::choiceToSigned(util::signedToChoice(INT64_MIN, INT64_MIN, INT64_MAX), INT64_MIN, INT64_MAX),
+              INT64_MIN);
+
+    // recording doesn't change the values drawn
+    int64_t seed = getCurrentTime();
+    Random rand(seed), recordingRand(seed);
+    auto buffer = util::make_shared<util::ChoiceBuffer>();
+    recordingRand.recordChoices(buffer);
+    auto draw = [](Random& r) {
+        vector<int64_t> values;
+        values.push_back(r.getRandomInt32(-100, 100));
+        values.push_back(r.getRandomBool() ? 1 : 0);
+        values.push_back(static_cast<int64_t>(r.getRandomUInt64()));
+        values.push_back(static_cast<int64_t>(r.getRandomDouble(-1.0, 1.0) * 1000000));
+        vector<int16_t> bulk(10);
+        r.fillBounded<int16_t>(bulk, -10, 10);
+        values.insert(values.end(), bulk.begin(), bulk.end());
+        return values;
+    };
+    auto values = draw(rand);
+    EXPECT_EQ(draw(recordingRand), values);
+    EXPECT_EQ(buffer->choices.size(), 14U);
+    EXPECT_EQ(recordingRand.getNumChoicesUsed(), 14U);
+
+    // replaying gives the same values, zero choices the simplest ones
+    Random replayingRand = Random::fromChoices(buffer);
+    EXPECT_EQ(draw(replayingRand), values);
+    auto zeros = util::make_shared<util::ChoiceBuffer>();
+    zeros->choices.resize(14, 0);
+    Random zeroRand = Random::fromChoices(zeros);
+    auto simplest = draw(zeroRand);
+    EXPECT_TRUE(std::all_of(simplest.begin(), simplest.end(), [](int64_t value) { return value == 0; }));
+    // as well as for integers drawn in bulk
+    zeros->choices.resize(20, 0);
+    Random zeroBulkRand = Random::fromChoices(zeros);
+    auto bulkSimplest = generateIntegers<int8_t>(zeroBulkRand, 10);
+    EXPECT_TRUE(std::all_of(bulkSimplest.begin(), bulkSimplest.end(), [](int8_t value) { return value == 0; }));
+    zeros->choices.resize(3);
+    Random shortRand = Random::fromChoices(zeros);
+    EXPECT_THROW(draw(shortRand), util::ChoiceOverrun);
+}
+
 TEST(UtilTestCase, Random8)
 {
     int64_t seed = getCurrentTime();
@@ -505,3 +737,71 @@ TEST(UtilTestCase, asserts)
     PROP_EXPECT_LT(a, b);
     PROP_EXPECT_GT(a, b) << " should print";
 }
+
+namespace {
+struct Unhashable
+{
+    int value;
+};
+struct Point
+{
+    int x, y;
+};
+}  // namespace
+
+namespace proptest {
+template <>
+struct Hash<Point>
+{
+    size_t operator()(const Point& p) const { return util::hashCombine(Hash<int>()(p.x), Hash<int>()(p.y)); }
+};
+}  // namespace proptest
+
+TEST(UtilTestCase, Hash)
+{
+    static_assert(util::Hashable<vector<pair<int, string>>>);
+    static_assert(util::Hashable<map<string, list<double>>>);
+    static_assert(util::Hashable<tuple<bool, UTF8String, shared_ptr<int>>>);
+    static_assert(util::Hashable<Point>);
+    static_assert(!util::Hashable<Unhashable>);
+    static_assert(!util::Hashable<vector<Unhashable>>);
+    static_assert(!util::Hashable<int*>);
+    static_assert(!util::Hashable<shared_ptr<Unhashable>>);
+
+    EXPECT_EQ(Hash<vector<int>>()({1, 2, 3}), Hash<vector<int>>()({1, 2, 3}));
+    EXPECT_NE(Hash<vector<int>>()({1, 2, 3}), Hash<vector<int>>()({3, 2, 1}));
+    EXPECT_NE(Hash<double>()(0.0), Hash<double>()(-0.0));
+    EXPECT_EQ(Hash<shared_ptr<int>>()(util::make_shared<int>(5)), Hash<shared_ptr<int>>()(util::make_shared<int>(5)));
+}
+
+TEST(UtilTestCase, ThreadPool)
+{
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4U);
+    mutex idsMutex;
+    set<thread::id> ids;
+    for (int batch = 0; batch < 50; batch++) {
+        vector<int> done(4, 0);
+        pool.run(4, [&](uint32_t i) {
+            done[i]++;
+            lock_guard<mutex> lock(idsMutex);
+            ids.insert(std::this_thread::get_id());
+        });
+        EXPECT_EQ(done, vector<int>(4, 1));
+    }
+    // the same workers run every batch
+    EXPECT_LE(ids.size(), 4U);
+    EXPECT_EQ(ids.count(std::this_thread::get_id()), 0U);
+
+    // fewer tasks than workers, and a task throwing
+    vector<int> done(2, 0);
+    EXPECT_THROW(pool.run(2,
+                          [&](uint32_t i) {
+                              done[i]++;
+                              if (i == 1)
+                                  throw runtime_error("task failed");
+                          }),
+                 runtime_error);
+    EXPECT_EQ(done, vector<int>(2, 1));
+    pool.run(0, [](uint32_t) { FAIL(); });
+}
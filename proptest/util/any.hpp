@@ -1,5 +1,6 @@
 #pragma once
 
+#include "arena.hpp"
 #include "std.hpp"
 
 namespace proptest
@@ -11,7 +12,7 @@ struct Any {
 
     template <typename T>
     Any(const T& t) {
-        ptr = static_pointer_cast<void>(util::make_shared<T>(t));
+        ptr = static_pointer_cast<void>(util::make_shared_in_arena<T>(t));
     }
 
     Any(const Any& other) : ptr(other.ptr) {}
@@ -30,7 +31,7 @@ template <typename T, typename... Args>
 Any make_any(Args&&... args)
 {
     Any any;
-    any.ptr = static_pointer_cast<void>(util::make_shared<T>(args...));
+    any.ptr = static_pointer_cast<void>(util::make_shared_in_arena<T>(util::forward<Args>(args)...));
     return any;
 }
 
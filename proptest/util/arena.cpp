@@ -0,0 +1,79 @@
+#include "arena.hpp"
+
+namespace proptest {
+namespace util {
+
+namespace {
+thread_local std::pmr::memory_resource* currentResource = nullptr;
+}
+
+Arena::Arena() : buffer(util::make_unique<std::pmr::monotonic_buffer_resource>()), numLive(0) {}
+
+Arena::~Arena() {}
+
+bool Arena::reset()
+{
+    if (numLive.load() != 0)
+        return false;
+    buffer->release();
+    return true;
+}
+
+Arena& Arena::forThisThread()
+{
+    struct ThreadArena
+    {
+        Arena* arena = new Arena();
+        // nodes still referenced after the thread exits (e.g. handed over to another thread) keep using the arena
+        ~ThreadArena()
+        {
+            if (arena->numLiveAllocations() == 0)
+                delete arena;
+        }
+    };
+    thread_local ThreadArena threadArena;
+    return *threadArena.arena;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment)
+{
+    void* p = buffer->allocate(bytes, alignment);
+    numLive++;
+    return p;
+}
+
+void Arena::do_deallocate(void*, size_t, size_t)
+{
+    numLive--;
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+ArenaScope::ArenaScope(bool enabled) : arena(nullptr), prevResource(currentResource)
+{
+    if (enabled) {
+        arena = &Arena::forThisThread();
+        currentResource = arena;
+    }
+}
+
+ArenaScope::~ArenaScope()
+{
+    if (arena) {
+        currentResource = prevResource;
+        // keep the memory while an outer scope still allocates from it
+        if (prevResource != arena)
+            arena->reset();
+    }
+}
+
+std::pmr::memory_resource* currentMemoryResource()
+{
+    return currentResource;
+}
+
+}  // namespace util
+}  // namespace proptest
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../api.hpp"
+#include "std.hpp"
+
+namespace proptest {
+namespace util {
+
+/**
+ * @brief Monotonic memory resource for the nodes of shrink trees and streams built during a run
+ * @details Allocation is a pointer bump and deallocation is a no-op, so building and dropping the nodes of a run
+ * doesn't go through the global heap. The memory is returned at once by `reset()`, which only happens when every
+ * allocation made from the arena has been deallocated, so nodes outliving a run are never freed under their owner.
+ *
+ * Each thread has its own arena (see `Arena::forThisThread()`), made current by an `ArenaScope`. Deallocations may
+ * come from any thread.
+ */
+class PROPTEST_API Arena : public std::pmr::memory_resource {
+public:
+    Arena();
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Returns the memory to the upstream resource if no allocation is alive
+     * @return true if the memory was returned
+     */
+    bool reset();
+
+    size_t numLiveAllocations() const { return numLive.load(); }
+
+    static Arena& forThisThread();
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    unique_ptr<std::pmr::monotonic_buffer_resource> buffer;
+    atomic<size_t> numLive;
+};
+
+/**
+ * @brief Makes the arena of this thread current for the nodes allocated during its lifetime
+ * @details Resets the arena on exit if nothing allocated from it is alive anymore. Does nothing if not enabled.
+ */
+struct PROPTEST_API ArenaScope
+{
+    explicit ArenaScope(bool enabled = true);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* arena;
+    std::pmr::memory_resource* prevResource;
+};
+
+// memory resource of the current arena scope, or nullptr if the global heap is used
+PROPTEST_API std::pmr::memory_resource* currentMemoryResource();
+
+/**
+ * @brief Same as `util::make_shared`, but allocates from the current arena if any
+ */
+template <typename T, typename... Args>
+shared_ptr<T> make_shared_in_arena(Args&&... args)
+{
+    if (std::pmr::memory_resource* resource = currentMemoryResource())
+        return util::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource), util::forward<Args>(args)...);
+    return util::make_shared<T>(util::forward<Args>(args)...);
+}
+
+}  // namespace util
+}  // namespace proptest
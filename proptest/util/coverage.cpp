@@ -0,0 +1,247 @@
+#include "coverage.hpp"
+#include "../Random.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace proptest {
+namespace util {
+
+namespace {
+
+// kept as plain arrays, as the instrumented code registers its counters from static initializers that may run before
+// the ones of this library
+struct CounterRegion
+{
+    uint8_t* begin;
+    uint8_t* end;
+};
+
+constexpr size_t maxRegions = 4096;
+CounterRegion regions[maxRegions];
+size_t numRegions = 0;
+
+// counters of the code instrumented with trace-pc-guard, indexed by guard - 1
+uint8_t* guardCounters = nullptr;
+uint32_t numGuards = 0;
+
+template <typename F>
+void forEachRegion(F&& f)
+{
+    for (size_t i = 0; i < numRegions; i++)
+        f(regions[i].begin, regions[i].end);
+    // last, so that counters registered later don't shift the indices of the ones seen before
+    if (numGuards > 0)
+        f(guardCounters, guardCounters + numGuards);
+}
+
+uint8_t hitBucket(uint8_t count)
+{
+    if (count <= 3)
+        return static_cast<uint8_t>(1 << (count - 1));
+    if (count < 8)
+        return 8;
+    if (count < 16)
+        return 16;
+    if (count < 32)
+        return 32;
+    if (count < 128)
+        return 64;
+    return 128;
+}
+
+void mutateOnce(vector<uint64_t>& choices, const vector<vector<uint64_t>>& entries, Random& rand)
+{
+    if (choices.empty())
+        return;
+    size_t pos = rand.getRandomSize(0, choices.size());
+    size_t len = rand.getRandomSize(1, 9);
+    size_t end = pos + len < choices.size() ? pos + len : choices.size();
+    uint64_t& choice = choices[pos];
+    switch (rand.getRandomSize(0, 9)) {
+        case 0:  // a value near the original
+            choice = rand.getRandomUInt64(0, choice < 16 ? 16 : (choice > UINT64_MAX / 2 ? UINT64_MAX : choice * 2));
+            break;
+        case 1:  // a single bit flipped
+            choice ^= uint64_t(1) << rand.getRandomSize(0, 64);
+            break;
+        case 2:
+            choice++;
+            break;
+        case 3:
+            if (choice > 0)
+                choice--;
+            break;
+        case 4:
+            choice = 0;
+            break;
+        case 5:
+            choices.erase(choices.begin() + pos, choices.begin() + end);
+            break;
+        case 6: {
+            vector<uint64_t> run(choices.begin() + pos, choices.begin() + end);
+            choices.insert(choices.begin() + pos, run.begin(), run.end());
+            break;
+        }
+        case 7: {
+            // continue with the tail of another entry
+            const vector<uint64_t>& other = entries[rand.getRandomSize(0, entries.size())];
+            choices.resize(pos);
+            if (!other.empty()) {
+                size_t from = rand.getRandomSize(0, other.size());
+                choices.insert(choices.end(), other.begin() + from, other.end());
+            }
+            break;
+        }
+        default:  // the rest is drawn afresh
+            choices.resize(pos);
+            break;
+    }
+}
+
+}  // namespace
+
+bool Coverage::isAvailable()
+{
+    return numCounters() > 0;
+}
+
+size_t Coverage::numCounters()
+{
+    size_t total = 0;
+    forEachRegion([&total](uint8_t* begin, uint8_t* end) { total += static_cast<size_t>(end - begin); });
+    return total;
+}
+
+void Coverage::reset()
+{
+    forEachRegion([](uint8_t* begin, uint8_t* end) { std::memset(begin, 0, static_cast<size_t>(end - begin)); });
+}
+
+void Coverage::registerCounters(uint8_t* begin, uint8_t* end)
+{
+    if (begin == end || numRegions >= maxRegions)
+        return;
+    for (size_t i = 0; i < numRegions; i++) {
+        if (regions[i].begin == begin)
+            return;
+    }
+    regions[numRegions++] = CounterRegion{begin, end};
+}
+
+void Coverage::unregisterCounters(uint8_t* begin, uint8_t* end)
+{
+    for (size_t i = 0; i < numRegions; i++) {
+        if (regions[i].begin == begin && regions[i].end == end) {
+            for (; i + 1 < numRegions; i++)
+                regions[i] = regions[i + 1];
+            numRegions--;
+            return;
+        }
+    }
+}
+
+size_t Coverage::update()
+{
+    seenBuckets.resize(numCounters(), 0);
+    size_t numNew = 0;
+    size_t offset = 0;
+    forEachRegion([&](uint8_t* begin, uint8_t* end) {
+        uint8_t* counter = begin;
+        while (counter < end) {
+            // most counters are not hit, skip them a word at a time
+            if (end - counter >= 8) {
+                uint64_t word;
+                std::memcpy(&word, counter, sizeof(word));
+                if (word == 0) {
+                    counter += 8;
+                    offset += 8;
+                    continue;
+                }
+            }
+            if (*counter != 0) {
+                uint8_t bucket = hitBucket(*counter);
+                if (!(seenBuckets[offset] & bucket)) {
+                    seenBuckets[offset] |= bucket;
+                    numNew++;
+                }
+            }
+            counter++;
+            offset++;
+        }
+    });
+    features += numNew;
+    return numNew;
+}
+
+void CoverageCorpus::add(vector<uint64_t> choices)
+{
+    entries.push_back(util::move(choices));
+}
+
+vector<uint64_t> CoverageCorpus::mutate(Random& rand) const
+{
+    if (entries.empty())
+        throw runtime_error("no entry to mutate in coverage corpus");
+    // the latest entries found the most recent coverage, and usually reach the deepest, so half of the time one of
+    // the latest few is taken
+    size_t numLatest = entries.size() < 4 ? entries.size() : 4;
+    size_t index = rand.getRandomBool() ? entries.size() - 1 - rand.getRandomSize(0, numLatest)
+                                        : rand.getRandomSize(0, entries.size());
+    vector<uint64_t> choices = entries[index];
+    uint32_t numMutations = rand.getRandomSize(1, 5);
+    for (uint32_t i = 0; i < numMutations; i++)
+        mutateOnce(choices, entries, rand);
+    return choices;
+}
+
+}  // namespace util
+}  // namespace proptest
+
+// Callbacks of SanitizerCoverage, called by the instrumented code. Only defined if enabled at build time, as they
+// would take the place of the ones of a sanitizer runtime. Weak, so that a fuzzing engine linked in takes over
+#ifdef PROPTEST_SANCOV_CALLBACKS
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PROPTEST_SANCOV_WEAK __attribute__((weak))
+#else
+#define PROPTEST_SANCOV_WEAK
+#endif
+
+extern "C" {
+
+PROPTEST_API PROPTEST_SANCOV_WEAK void __sanitizer_cov_8bit_counters_init(uint8_t* start, uint8_t* stop)
+{
+    proptest::util::Coverage::registerCounters(start, stop);
+}
+
+PROPTEST_API PROPTEST_SANCOV_WEAK void __sanitizer_cov_pcs_init(const uintptr_t*, const uintptr_t*) {}
+
+PROPTEST_API PROPTEST_SANCOV_WEAK void __sanitizer_cov_trace_pc_guard_init(uint32_t* start, uint32_t* stop)
+{
+    using namespace proptest::util;
+    // called once per module, possibly more than once with the same guards
+    if (start == stop || *start)
+        return;
+    uint32_t count = static_cast<uint32_t>(stop - start);
+    auto* grown = static_cast<uint8_t*>(std::realloc(guardCounters, numGuards + count));
+    if (!grown)
+        return;
+    std::memset(grown + numGuards, 0, count);
+    guardCounters = grown;
+    for (uint32_t* guard = start; guard < stop; guard++)
+        *guard = ++numGuards;
+}
+
+PROPTEST_API PROPTEST_SANCOV_WEAK void __sanitizer_cov_trace_pc_guard(uint32_t* guard)
+{
+    if (!*guard)
+        return;
+    // saturates like the inline 8-bit counters, instead of wrapping back to a low bucket
+    uint8_t& counter = proptest::util::guardCounters[*guard - 1];
+    if (counter != 255)
+        counter++;
+}
+
+}  // extern "C"
+
+#endif  // PROPTEST_SANCOV_CALLBACKS
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../api.hpp"
+#include "std.hpp"
+
+namespace proptest {
+
+class Random;
+
+namespace util {
+
+/**
+ * @brief Edge coverage of the code instrumented with SanitizerCoverage
+ * @details Code compiled by Clang with `-fsanitize-coverage=inline-8bit-counters` or
+ * `-fsanitize-coverage=trace-pc-guard` registers a counter per edge through the `__sanitizer_cov_*` callbacks, defined
+ * by this library if it is built with `PROPTEST_SANCOV_CALLBACKS`. The counters are cleared before a run and merged
+ * after it. Each counter gives a feature per bucket
+ * of its hit count (1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+), so that looping a different number of times counts as
+ * new coverage as well.
+ */
+class PROPTEST_API Coverage {
+public:
+    // true if instrumented code has registered its counters
+    static bool isAvailable();
+    static size_t numCounters();
+    // clears the counters of all the instrumented code
+    static void reset();
+    // registers an array of 8-bit counters, as the instrumented code does when loaded
+    static void registerCounters(uint8_t* begin, uint8_t* end);
+    // removes an array registered with registerCounters, e.g. before it goes out of scope. Not to be called while a
+    // coverage-guided test runs
+    static void unregisterCounters(uint8_t* begin, uint8_t* end);
+
+    // merges the counters hit since the last reset, returns the number of features not seen before
+    size_t update();
+    size_t numFeatures() const { return features; }
+
+private:
+    vector<uint8_t> seenBuckets;  // buckets of hit counts seen, per counter
+    size_t features = 0;
+};
+
+/**
+ * @brief Choices of the runs that found new coverage (see `ChoiceBuffer`)
+ * @details Later runs are generated from mutated copies of these choices: choices are redrawn near their value,
+ * flipped, zeroed, runs of choices are deleted or duplicated, and entries are spliced together. Drawing past the end of
+ * the mutated choices continues with fresh random values.
+ */
+class PROPTEST_API CoverageCorpus {
+public:
+    void add(vector<uint64_t> choices);
+    bool empty() const { return entries.empty(); }
+    size_t size() const { return entries.size(); }
+
+    // a randomly chosen entry with a few random mutations applied
+    vector<uint64_t> mutate(Random& rand) const;
+
+private:
+    vector<vector<uint64_t>> entries;
+};
+
+}  // namespace util
+}  // namespace proptest
@@ -0,0 +1,176 @@
+#include "genprofile.hpp"
+#include "histogram.hpp"
+
+namespace proptest {
+namespace util {
+
+namespace {
+
+thread_local GenProfileNode* currentNode = nullptr;
+thread_local uint64_t allocationCount = 0;
+thread_local uint64_t allocatedByteCount = 0;
+
+void mergeNode(GenProfileNode& node, const GenProfileNode& other)
+{
+    node.calls += other.calls;
+    node.nanos += other.nanos;
+    node.allocations += other.allocations;
+    node.allocatedBytes += other.allocatedBytes;
+    node.rejections += other.rejections;
+    for (auto& otherChild : other.children)
+        mergeNode(node.child(otherChild->name), *otherChild);
+}
+
+void printNode(ostream& os, const GenProfileNode& node, uint64_t totalNanos, size_t depth);
+
+// costliest first
+void printChildren(ostream& os, const GenProfileNode& node, uint64_t totalNanos, size_t depth)
+{
+    vector<const GenProfileNode*> sorted;
+    for (auto& child : node.children)
+        sorted.push_back(child.get());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const GenProfileNode* a, const GenProfileNode* b) { return a->nanos > b->nanos; });
+    for (auto child : sorted)
+        printNode(os, *child, totalNanos, depth);
+}
+
+void printNode(ostream& os, const GenProfileNode& node, uint64_t totalNanos, size_t depth)
+{
+    auto precision = os.precision();
+    os << string(2 * depth + 2, ' ') << node.name << ": " << formatNanos(node.nanos) << " (" << std::fixed
+       << std::setprecision(1) << (totalNanos == 0 ? 0.0 : 100.0 * static_cast<double>(node.nanos) / totalNanos)
+       << "%" << std::defaultfloat << std::setprecision(precision) << ", self " << formatNanos(node.selfNanos()) << "), " << node.calls << " calls";
+    if (node.allocations > 0)
+        os << ", " << node.allocations << " allocations";
+    if (node.rejections > 0)
+        os << ", " << node.rejections << " rejected";
+    os << endl;
+    printChildren(os, node, totalNanos, depth + 1);
+}
+
+void printFoldedNode(ostream& os, const GenProfileNode& node, const string& path)
+{
+    string nodePath = path.empty() ? node.name : path + ";" + node.name;
+    if (node.selfNanos() > 0)
+        os << nodePath << " " << node.selfNanos() << endl;
+    for (auto& child : node.children)
+        printFoldedNode(os, *child, nodePath);
+}
+
+}  // namespace
+
+GenProfileNode& GenProfileNode::child(const string& childName)
+{
+    for (auto& existing : children) {
+        if (existing->name == childName)
+            return *existing;
+    }
+    children.push_back(util::make_unique<GenProfileNode>(childName));
+    return *children.back();
+}
+
+const GenProfileNode* GenProfileNode::find(const string& childName) const
+{
+    for (auto& existing : children) {
+        if (existing->name == childName)
+            return existing.get();
+    }
+    return nullptr;
+}
+
+uint64_t GenProfileNode::selfNanos() const
+{
+    uint64_t childNanos = 0;
+    for (auto& child : children)
+        childNanos += child->nanos;
+    return nanos > childNanos ? nanos - childNanos : 0;
+}
+
+uint64_t GenProfileNode::selfAllocations() const
+{
+    uint64_t childAllocations = 0;
+    for (auto& child : children)
+        childAllocations += child->allocations;
+    return allocations > childAllocations ? allocations - childAllocations : 0;
+}
+
+GenProfile::GenProfile() : rootNode(util::make_unique<GenProfileNode>("generation")) {}
+
+void GenProfile::merge(const GenProfile& other)
+{
+    mergeNode(*rootNode, *other.rootNode);
+}
+
+void GenProfile::print(ostream& os) const
+{
+    // the root only collects the top level generators, its own time is theirs
+    uint64_t totalNanos = 0;
+    for (auto& child : rootNode->children)
+        totalNanos += child->nanos;
+    os << "  generation profile (total, share, self, calls):" << endl;
+    printChildren(os, *rootNode, totalNanos, 1);
+}
+
+void GenProfile::printFolded(ostream& os) const
+{
+    for (auto& child : rootNode->children)
+        printFoldedNode(os, *child, rootNode->name);
+}
+
+GenProfileNode* GenProfile::current()
+{
+    return currentNode;
+}
+
+void GenProfile::countAllocation(size_t size)
+{
+    allocationCount++;
+    allocatedByteCount += size;
+}
+
+uint64_t GenProfile::numAllocations()
+{
+    return allocationCount;
+}
+
+uint64_t GenProfile::numAllocatedBytes()
+{
+    return allocatedByteCount;
+}
+
+GenProfileSession::GenProfileSession(GenProfile* profile) : previous(currentNode), active(profile != nullptr)
+{
+    if (active) {
+        currentNode = &profile->root();
+        currentNode->calls++;
+    }
+}
+
+GenProfileSession::~GenProfileSession()
+{
+    if (active)
+        currentNode = previous;
+}
+
+void GenProfileScope::enter(GenProfileNode& child)
+{
+    node = &child;
+    currentNode = node;
+    startAllocations = allocationCount;
+    startAllocatedBytes = allocatedByteCount;
+    startTime = steady_clock::now();
+}
+
+void GenProfileScope::leave()
+{
+    auto nanos = static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - startTime).count());
+    node->calls++;
+    node->nanos += nanos;
+    node->allocations += allocationCount - startAllocations;
+    node->allocatedBytes += allocatedByteCount - startAllocatedBytes;
+    currentNode = parent;
+}
+
+}  // namespace util
+}  // namespace proptest
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "../api.hpp"
+#include "std.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace proptest {
+namespace util {
+
+/**
+ * @brief A generator in the tree of a `GenProfile`, with its cost including the generators it called
+ */
+struct PROPTEST_API GenProfileNode
+{
+    explicit GenProfileNode(const string& _name) : name(_name) {}
+
+    // child of the given name, created on first use
+    GenProfileNode& child(const string& childName);
+    // child of the given name, nullptr if none
+    const GenProfileNode* find(const string& childName) const;
+
+    uint64_t selfNanos() const;
+    uint64_t selfAllocations() const;
+
+    string name;
+    uint64_t calls = 0;
+    uint64_t nanos = 0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t rejections = 0;  // values rejected by a filter or discarded, retried in this generator
+    vector<unique_ptr<GenProfileNode>> children;
+};
+
+/**
+ * @brief Where generation time goes, per generator node of the composition
+ * @details Generators run while a `GenProfileSession` is active on the thread are recorded as a tree: combinators
+ * (`filter`, `oneOf`, `map`, `flatMap`, `dependency`, `chain`) and generators named with `profile()` each open a
+ * node under the one that called them. Each node counts its calls, wall time, allocations and rejections, including
+ * those of its children. Allocations are only counted if `PROPTEST_COUNT_ALLOCATIONS` is used in the program.
+ */
+class PROPTEST_API GenProfile {
+public:
+    GenProfile();
+
+    const GenProfileNode& root() const { return *rootNode; }
+    GenProfileNode& root() { return *rootNode; }
+    bool empty() const { return rootNode->children.empty(); }
+
+    // accumulates another profile (e.g. of a worker thread) into this
+    void merge(const GenProfile& other);
+
+    // indented tree, with the share of the total generation time of each node
+    void print(ostream& os) const;
+    // one line per path with its self time in nanoseconds, in the folded format of flame graph tools
+    void printFolded(ostream& os) const;
+
+    // innermost node being profiled on this thread, nullptr if profiling is not active
+    static GenProfileNode* current();
+
+    // counts an allocation on this thread, called by `PROPTEST_COUNT_ALLOCATIONS` or directly by a generator
+    static void countAllocation(size_t size);
+    static uint64_t numAllocations();
+    static uint64_t numAllocatedBytes();
+
+private:
+    unique_ptr<GenProfileNode> rootNode;
+};
+
+/**
+ * @brief Makes generators called on this thread record into `profile` while alive
+ */
+struct PROPTEST_API GenProfileSession
+{
+    explicit GenProfileSession(GenProfile* profile);
+    ~GenProfileSession();
+
+    GenProfileNode* previous;
+    bool active;
+};
+
+/**
+ * @brief Records a call of a generator as a node under the current one, if profiling is active on this thread
+ * @details Does nothing when not profiling, so that combinators can keep it in place.
+ */
+struct PROPTEST_API GenProfileScope
+{
+    explicit GenProfileScope(const char* name) : parent(GenProfile::current())
+    {
+        if (parent)
+            enter(parent->child(name));
+    }
+
+    GenProfileScope(const string& name) : parent(GenProfile::current())
+    {
+        if (parent)
+            enter(parent->child(name));
+    }
+
+    ~GenProfileScope()
+    {
+        if (node)
+            leave();
+    }
+
+    // a generated value was rejected and is retried
+    void reject()
+    {
+        if (node)
+            node->rejections++;
+    }
+
+    bool active() const { return node != nullptr; }
+
+private:
+    void enter(GenProfileNode& child);
+    void leave();
+
+    GenProfileNode* parent;
+    GenProfileNode* node = nullptr;
+    steady_clock::time_point startTime;
+    uint64_t startAllocations = 0;
+    uint64_t startAllocatedBytes = 0;
+};
+
+}  // namespace util
+}  // namespace proptest
+
+/**
+ * @brief Replaces the global `operator new` with one counting allocations for `GenProfile`
+ * @details Use once, at namespace scope of a single source file of the test program.
+ */
+#define PROPTEST_COUNT_ALLOCATIONS                                    \
+    void* operator new(std::size_t size)                              \
+    {                                                                 \
+        ::proptest::util::GenProfile::countAllocation(size);          \
+        if (void* ptr = std::malloc(size == 0 ? 1 : size))            \
+            return ptr;                                               \
+        throw std::bad_alloc();                                       \
+    }                                                                 \
+    void operator delete(void* ptr) noexcept { std::free(ptr); }      \
+    void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
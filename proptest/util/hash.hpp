@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstring>
+#include "std.hpp"
+
+/**
+ * @file hash.hpp
+ * @brief Hashing of generated values, used to recognize shrink candidates already tested
+ */
+
+namespace proptest {
+
+/**
+ * @brief Hash function for values of type T, if available
+ * @details Defined for types with `std::hash` (except pointers, which would be hashed by address), strings,
+ * floating point numbers (by their bits) and standard containers, pairs and tuples of those. Other types have no
+ * `operator()`, and properties taking them are not cached while shrinking. You can provide one by specializing
+ * `Hash` for your type:
+ * @code
+ * template <>
+ * struct Hash<Point> {
+ *     size_t operator()(const Point& p) const { return util::hashCombine(Hash<int>()(p.x), Hash<int>()(p.y)); }
+ * };
+ * @endcode
+ * Equal values must have equal hashes.
+ */
+template <typename T>
+struct Hash
+{
+};
+
+namespace util {
+
+template <typename T>
+concept Hashable = requires(const T& t) {
+    { Hash<T>()(t) } -> convertible_to<size_t>;
+};
+
+template <typename T>
+concept StdHashable = requires(const T& t) {
+    { std::hash<T>()(t) } -> convertible_to<size_t>;
+};
+
+inline size_t hashCombine(size_t seed, size_t value)
+{
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+template <typename Container>
+size_t hashRange(const Container& container)
+{
+    size_t seed = container.size();
+    for (const auto& elem : container)
+        seed = hashCombine(seed, Hash<decay_t<decltype(elem)>>()(elem));
+    return seed;
+}
+
+}  // namespace util
+
+// pointers and smart pointers are left out, as std::hash hashes them by address
+template <typename T>
+    requires(util::StdHashable<T> && !is_pointer<T>::value && !requires { typename T::element_type; } &&
+             !std::is_floating_point_v<T>)
+struct Hash<T>
+{
+    size_t operator()(const T& t) const { return std::hash<T>()(t); }
+};
+
+// UTF8String and the other string types derived from string
+template <typename T>
+    requires(std::is_base_of_v<string, T> && !is_same_v<T, string>)
+struct Hash<T>
+{
+    size_t operator()(const T& t) const { return std::hash<string>()(t); }
+};
+
+// by bits, so that e.g. 0.0 and -0.0 are told apart
+template <typename T>
+    requires(std::is_floating_point_v<T>)
+struct Hash<T>
+{
+    size_t operator()(const T& t) const
+    {
+        unsigned char bytes[sizeof(T)] = {};
+        std::memcpy(bytes, &t, sizeof(T));
+        return std::hash<string>()(string(reinterpret_cast<const char*>(bytes), sizeof(T)));
+    }
+};
+
+template <typename T>
+    requires(util::Hashable<T>)
+struct Hash<vector<T>>
+{
+    size_t operator()(const vector<T>& t) const { return util::hashRange(t); }
+};
+
+template <typename T>
+    requires(util::Hashable<T>)
+struct Hash<list<T>>
+{
+    size_t operator()(const list<T>& t) const { return util::hashRange(t); }
+};
+
+template <typename T>
+    requires(util::Hashable<T>)
+struct Hash<set<T>>
+{
+    size_t operator()(const set<T>& t) const { return util::hashRange(t); }
+};
+
+template <typename K, typename V>
+    requires(util::Hashable<K> && util::Hashable<V>)
+struct Hash<map<K, V>>
+{
+    size_t operator()(const map<K, V>& t) const
+    {
+        size_t seed = t.size();
+        for (const auto& [key, value] : t)
+            seed = util::hashCombine(util::hashCombine(seed, Hash<K>()(key)), Hash<V>()(value));
+        return seed;
+    }
+};
+
+template <typename A, typename B>
+    requires(util::Hashable<A> && util::Hashable<B>)
+struct Hash<pair<A, B>>
+{
+    size_t operator()(const pair<A, B>& t) const { return util::hashCombine(Hash<A>()(t.first), Hash<B>()(t.second)); }
+};
+
+template <typename... Ts>
+    requires(util::Hashable<Ts> && ...)
+struct Hash<tuple<Ts...>>
+{
+    size_t operator()(const tuple<Ts...>& t) const
+    {
+        return std::apply(
+            [](const Ts&... elems) {
+                size_t seed = sizeof...(Ts);
+                ((seed = util::hashCombine(seed, Hash<Ts>()(elems))), ...);
+                return seed;
+            },
+            t);
+    }
+};
+
+// by the pointee, as the address of a generated value may be reused by another one
+template <typename T>
+    requires(util::Hashable<T>)
+struct Hash<shared_ptr<T>>
+{
+    size_t operator()(const shared_ptr<T>& t) const { return t ? util::hashCombine(1, Hash<T>()(*t)) : 0; }
+};
+
+}  // namespace proptest
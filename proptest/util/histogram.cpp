@@ -0,0 +1,95 @@
+#include "histogram.hpp"
+#include <bit>
+
+namespace proptest {
+namespace util {
+
+namespace {
+
+constexpr size_t subBuckets = 16;
+constexpr size_t numBuckets = subBuckets + (64 - 4) * subBuckets;
+
+size_t bucketOf(uint64_t value)
+{
+    if (value < subBuckets)
+        return static_cast<size_t>(value);
+    size_t exponent = 63 - static_cast<size_t>(std::countl_zero(value));
+    size_t sub = static_cast<size_t>(value >> (exponent - 4)) & (subBuckets - 1);
+    return subBuckets + (exponent - 4) * subBuckets + sub;
+}
+
+// smallest value of the bucket
+uint64_t lowerBound(size_t bucket)
+{
+    if (bucket < subBuckets)
+        return bucket;
+    size_t exponent = (bucket - subBuckets) / subBuckets + 4;
+    uint64_t sub = (bucket - subBuckets) % subBuckets;
+    return (subBuckets + sub) << (exponent - 4);
+}
+
+}  // namespace
+
+string formatNanos(uint64_t nanos)
+{
+    stringstream str;
+    str << std::setprecision(3);
+    if (nanos < 1000)
+        str << nanos << "ns";
+    else if (nanos < 1000000)
+        str << static_cast<double>(nanos) / 1e3 << "us";
+    else if (nanos < 1000000000)
+        str << static_cast<double>(nanos) / 1e6 << "ms";
+    else
+        str << static_cast<double>(nanos) / 1e9 << "s";
+    return str.str();
+}
+
+void Histogram::record(uint64_t value)
+{
+    if (buckets.empty())
+        buckets.resize(numBuckets, 0);
+    buckets[bucketOf(value)]++;
+    numValues++;
+    sum += value;
+    if (value > maxValue)
+        maxValue = value;
+}
+
+void Histogram::merge(const Histogram& other)
+{
+    if (other.numValues == 0)
+        return;
+    if (buckets.empty())
+        buckets.resize(numBuckets, 0);
+    for (size_t i = 0; i < numBuckets; i++)
+        buckets[i] += other.buckets[i];
+    numValues += other.numValues;
+    sum += other.sum;
+    if (other.maxValue > maxValue)
+        maxValue = other.maxValue;
+}
+
+uint64_t Histogram::percentile(double p) const
+{
+    if (numValues == 0)
+        return 0;
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(numValues));
+    if (rank >= numValues)
+        rank = numValues - 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < numBuckets; i++) {
+        seen += buckets[i];
+        if (seen > rank) {
+            // middle of the bucket, as the values in it are not known
+            uint64_t low = lowerBound(i);
+            uint64_t high = i + 1 < numBuckets ? lowerBound(i + 1) : low;
+            uint64_t mid = low + (high - low) / 2;
+            return mid < maxValue ? mid : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+}  // namespace util
+}  // namespace proptest
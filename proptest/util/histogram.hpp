@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../api.hpp"
+#include "std.hpp"
+
+namespace proptest {
+namespace util {
+
+/**
+ * @brief Histogram of durations in nanoseconds, with log-linear buckets
+ * @details Values below 16 are counted exactly. Above, each power of two is split in 16 buckets, so that a percentile
+ * is within about 6% of the recorded value. The buckets are allocated on the first record.
+ */
+class PROPTEST_API Histogram {
+public:
+    void record(uint64_t value);
+    void merge(const Histogram& other);
+
+    uint64_t count() const { return numValues; }
+    uint64_t total() const { return sum; }
+    uint64_t max() const { return maxValue; }
+    // value below which fraction `p` of the values are, 0 if there is none
+    uint64_t percentile(double p) const;
+
+private:
+    vector<uint64_t> buckets;
+    uint64_t numValues = 0;
+    uint64_t sum = 0;
+    uint64_t maxValue = 0;
+};
+
+// duration in nanoseconds as a short human readable string, e.g. "1.25ms"
+PROPTEST_API string formatNanos(uint64_t nanos);
+
+/**
+ * @brief Records the time from its construction to its destruction into a histogram, if any
+ * @details Does nothing without a histogram, so that timing can be left in place when not collected. Time spent in
+ * a nested phase can be excluded with `exclude()`.
+ */
+struct PhaseTimer
+{
+    explicit PhaseTimer(Histogram* _histogram) : histogram(_histogram)
+    {
+        if (histogram)
+            startTime = steady_clock::now();
+    }
+
+    ~PhaseTimer()
+    {
+        if (histogram) {
+            auto nanos = static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - startTime).count());
+            histogram->record(nanos > excludedNanos ? nanos - excludedNanos : 0);
+        }
+    }
+
+    void exclude(uint64_t nanos) { excludedNanos += nanos; }
+
+    Histogram* histogram;
+    steady_clock::time_point startTime;
+    uint64_t excludedNanos = 0;
+};
+
+}  // namespace util
+}  // namespace proptest
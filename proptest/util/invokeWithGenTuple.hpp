@@ -3,15 +3,36 @@
 #include "invokeWithArgs.hpp"
 #include "tuple.hpp"
 #include "../generator/util.hpp"
+#include "genprofile.hpp"
 
 namespace proptest {
 namespace util {
 
+// generates an argument, as a node of its own in the generation profile if profiling
+template <size_t index, typename GEN>
+decltype(auto) generateArg(GEN& gen, Random& rand, bool profiling)
+{
+    if (!profiling)
+        return gen(rand);
+    GenProfileScope scope("arg " + to_string(index));
+    return gen(rand);
+}
+
 template <typename Function, typename GenTuple, size_t... index>
-decltype(auto) invokeWithGenHelper(Random& rand, Function&& f, GenTuple&& genTup, index_sequence<index...>)
+decltype(auto) invokeWithGenHelper(Random& rand, Function&& f, GenTuple&& genTup, bool valueOnly,
+                                   uint64_t* generationNanos, GenProfile* genProfile, index_sequence<index...>)
 {
-    // invoke generator with random
-    auto valueTup = util::make_tuple(get<index>(genTup)(rand)...);
+    // invoke generator with random, without building the shrinks if valueOnly
+    auto valueTup = [&]() {
+        ValueOnlyScope scope(valueOnly);
+        GenProfileSession profiling(genProfile);
+        if (!generationNanos)
+            return util::make_tuple(generateArg<index>(get<index>(genTup), rand, profiling.active)...);
+        auto startTime = steady_clock::now();
+        auto generated = util::make_tuple(generateArg<index>(get<index>(genTup), rand, profiling.active)...);
+        *generationNanos = static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - startTime).count());
+        return generated;
+    }();
     // get value from shrinkable
     auto values = transformHeteroTuple<ShrinkableGet>(util::forward<decltype(valueTup)>(valueTup));
     try {
@@ -22,12 +43,15 @@ decltype(auto) invokeWithGenHelper(Random& rand, Function&& f, GenTuple&& genTup
     }
 }
 
+// generates the arguments and calls `f` with them. The time taken by generation is set to `generationNanos` if given,
+// and the generators are profiled into `genProfile` if given
 template <typename Function, typename Tuple>
-decltype(auto) invokeWithGenTuple(Random& rand, Function&& f, Tuple&& genTup)
+decltype(auto) invokeWithGenTuple(Random& rand, Function&& f, Tuple&& genTup, bool valueOnly = false,
+                                  uint64_t* generationNanos = nullptr, GenProfile* genProfile = nullptr)
 {
     constexpr auto Arity = function_traits<remove_reference_t<decltype(f)> >::arity;
-    return invokeWithGenHelper(rand, util::forward<Function>(f), util::forward<Tuple>(genTup),
-                               make_index_sequence<Arity>{});
+    return invokeWithGenHelper(rand, util::forward<Function>(f), util::forward<Tuple>(genTup), valueOnly,
+                               generationNanos, genProfile, make_index_sequence<Arity>{});
 }
 
 template <typename TUP1, typename TUP2, size_t N>
@@ -0,0 +1,109 @@
+#include "parallel.hpp"
+
+namespace proptest {
+namespace util {
+
+void runParallel(uint32_t numThreads, function<void(uint32_t)> worker)
+{
+    if (numThreads == 0)
+        return;
+    if (numThreads == 1) {
+        worker(0);
+        return;
+    }
+
+    mutex exceptionMutex;
+    exception_ptr firstException;
+    vector<thread> threads;
+    threads.reserve(numThreads);
+    for (uint32_t i = 0; i < numThreads; i++) {
+        threads.emplace_back([&worker, &exceptionMutex, &firstException, i]() {
+            try {
+                worker(i);
+            } catch (...) {
+                lock_guard<mutex> lock(exceptionMutex);
+                if (!firstException)
+                    firstException = std::current_exception();
+            }
+        });
+    }
+
+    for (auto& t : threads)
+        t.join();
+
+    if (firstException)
+        std::rethrow_exception(firstException);
+}
+
+ThreadPool::ThreadPool(uint32_t _numThreads)
+{
+    threads.reserve(_numThreads);
+    for (uint32_t i = 0; i < _numThreads; i++)
+        threads.emplace_back([this]() { work(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> lock(batchMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& t : threads)
+        t.join();
+}
+
+void ThreadPool::run(uint32_t numTasks, function<void(uint32_t)> task)
+{
+    if (numTasks == 0)
+        return;
+    // nothing to hand over to
+    if (threads.empty()) {
+        for (uint32_t i = 0; i < numTasks; i++)
+            task(i);
+        return;
+    }
+
+    exception_ptr exception;
+    {
+        unique_lock<mutex> lock(batchMutex);
+        batchTask = util::move(task);
+        numBatchTasks = numTasks;
+        nextTask = 0;
+        numFinished = 0;
+        firstException = nullptr;
+        taskAvailable.notify_all();
+        batchFinished.wait(lock, [this]() { return numFinished == numBatchTasks; });
+        batchTask = nullptr;
+        numBatchTasks = 0;
+        exception = firstException;
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void ThreadPool::work()
+{
+    unique_lock<mutex> lock(batchMutex);
+    while (true) {
+        taskAvailable.wait(lock, [this]() { return stopping || nextTask < numBatchTasks; });
+        if (stopping)
+            return;
+        uint32_t i = nextTask++;
+        lock.unlock();
+        exception_ptr exception;
+        try {
+            batchTask(i);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        lock.lock();
+        if (exception && !firstException)
+            firstException = exception;
+        if (++numFinished == numBatchTasks)
+            batchFinished.notify_one();
+    }
+}
+
+}  // namespace util
+}  // namespace proptest
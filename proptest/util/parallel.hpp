@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../api.hpp"
+#include "std.hpp"
+
+namespace proptest {
+namespace util {
+
+/**
+ * @brief Runs a worker function on a number of threads and waits for all of them to finish
+ * @details Each worker is given its own index in [0, numThreads). If any of the workers throws, the first exception
+ * caught is rethrown on the calling thread after all the workers have been joined.
+ * @param numThreads Number of worker threads. The worker is run on the calling thread if 1 is given, and not at all
+ * if 0 is given
+ * @param worker Function to run, taking the index of the worker as argument
+ */
+PROPTEST_API void runParallel(uint32_t numThreads, function<void(uint32_t)> worker);
+
+/**
+ * @brief Fixed set of worker threads, running batches of tasks until destroyed
+ * @details Unlike `runParallel`, the threads are started once, so that running many small batches doesn't pay for
+ * creating and joining threads each time.
+ */
+class PROPTEST_API ThreadPool {
+public:
+    explicit ThreadPool(uint32_t _numThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Runs `task` for each index in [0, numTasks) on the workers and waits for all of them to finish
+     * @details If any of the tasks throws, the first exception caught is rethrown on the calling thread after the
+     * batch has finished.
+     */
+    void run(uint32_t numTasks, function<void(uint32_t)> task);
+
+    uint32_t size() const { return static_cast<uint32_t>(threads.size()); }
+
+private:
+    void work();
+
+    vector<thread> threads;
+    mutex batchMutex;
+    condition_variable taskAvailable;
+    condition_variable batchFinished;
+    function<void(uint32_t)> batchTask;
+    uint32_t numBatchTasks = 0;
+    uint32_t nextTask = 0;
+    uint32_t numFinished = 0;
+    exception_ptr firstException;
+    bool stopping = false;
+};
+
+}  // namespace util
+}  // namespace proptest
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "std.hpp"
+#include <iterator>
+
+namespace proptest {
+namespace util {
+
+/**
+ * @brief Vector that shares unchanged elements with its copies
+ * @details Elements are kept in chunks of up to `chunkSize` elements, and the vector is a table of views into the
+ * chunks. Copying the vector only copies a pointer to the table. `set()` copies the table and the chunk it writes to
+ * only if they are shared with another vector, and `slice()`/`append()` only create views on existing chunks, so a
+ * copy with a few changed elements, or a sublist, costs memory in proportion to the changes rather than to the size.
+ * @tparam T element type
+ */
+template <typename T>
+class PersistentVector {
+public:
+    static constexpr size_t chunkSize = 32;
+
+private:
+    // elements [begin, end) of a chunk, which are the elements [offset, offset + end - begin) of the vector
+    struct View
+    {
+        shared_ptr<vector<T>> chunk;
+        size_t begin;
+        size_t end;
+        size_t offset;
+
+        size_t size() const { return end - begin; }
+    };
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() : views(nullptr), viewIndex(0), pos(0) {}
+        const_iterator(const vector<View>* _views, size_t _viewIndex)
+            : views(_views), viewIndex(_viewIndex), pos(_viewIndex < _views->size() ? (*_views)[_viewIndex].begin : 0)
+        {
+        }
+
+        reference operator*() const { return (*(*views)[viewIndex].chunk)[pos]; }
+        pointer operator->() const { return &**this; }
+
+        const_iterator& operator++()
+        {
+            if (++pos == (*views)[viewIndex].end) {
+                ++viewIndex;
+                pos = viewIndex < views->size() ? (*views)[viewIndex].begin : 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            const_iterator prev = *this;
+            ++*this;
+            return prev;
+        }
+
+        bool operator==(const const_iterator& other) const
+        {
+            return viewIndex == other.viewIndex && pos == other.pos;
+        }
+
+    private:
+        const vector<View>* views;
+        size_t viewIndex;
+        size_t pos;
+    };
+
+    PersistentVector() : views(util::make_shared<vector<View>>()), numElements(0) {}
+
+    template <typename InputIt>
+    PersistentVector(InputIt first, InputIt last) : PersistentVector()
+    {
+        while (first != last) {
+            auto chunk = util::make_shared<vector<T>>();
+            chunk->reserve(chunkSize);
+            for (; first != last && chunk->size() < chunkSize; ++first)
+                chunk->push_back(*first);
+            size_t chunkLength = chunk->size();
+            views->push_back(View{util::move(chunk), 0, chunkLength, numElements});
+            numElements += chunkLength;
+        }
+    }
+
+    size_t size() const { return numElements; }
+    bool empty() const { return numElements == 0; }
+
+    const T& operator[](size_t i) const
+    {
+        const View& view = (*views)[findView(i)];
+        return (*view.chunk)[view.begin + i - view.offset];
+    }
+
+    const_iterator begin() const { return const_iterator(views.get(), 0); }
+    const_iterator end() const { return const_iterator(views.get(), views->size()); }
+
+    // replaces the `i`th element, copying its chunk first if it's shared
+    void set(size_t i, const T& value)
+    {
+        if (views.use_count() > 1)
+            views = util::make_shared<vector<View>>(*views);
+        View& view = (*views)[findView(i)];
+        if (view.chunk.use_count() > 1) {
+            view.chunk = util::make_shared<vector<T>>(view.chunk->begin() + view.begin, view.chunk->begin() + view.end);
+            view.end = view.size();
+            view.begin = 0;
+        }
+        (*view.chunk)[i - view.offset] = value;
+    }
+
+    // elements [from, to), sharing the chunks
+    PersistentVector slice(size_t from, size_t to) const
+    {
+        if (from > to || to > numElements)
+            throw invalid_argument("invalid slice [" + to_string(from) + ", " + to_string(to) +
+                                   ") of size " + to_string(numElements));
+        PersistentVector result;
+        if (from == to)
+            return result;
+        for (size_t v = findView(from); v < views->size() && (*views)[v].offset < to; v++) {
+            const View& view = (*views)[v];
+            size_t begin = from > view.offset ? view.begin + (from - view.offset) : view.begin;
+            size_t end = to < view.offset + view.size() ? view.begin + (to - view.offset) : view.end;
+            result.appendView(view.chunk, begin, end);
+        }
+        return result;
+    }
+
+    // appends the elements of other, sharing its chunks
+    void append(const PersistentVector& other)
+    {
+        if (other.empty())
+            return;
+        if (views.use_count() > 1)
+            views = util::make_shared<vector<View>>(*views);
+        for (const View& view : *other.views)
+            appendView(view.chunk, view.begin, view.end);
+        // views left small by repeated slicing are merged back into whole chunks
+        if (views->size() > 2 * (numElements / chunkSize) + 4)
+            *this = PersistentVector(begin(), end());
+    }
+
+    vector<T> toVector() const { return vector<T>(begin(), end()); }
+
+private:
+    void appendView(const shared_ptr<vector<T>>& chunk, size_t begin, size_t end)
+    {
+        // continues the last view if the elements are contiguous in the same chunk
+        if (!views->empty() && views->back().chunk == chunk && views->back().end == begin)
+            views->back().end = end;
+        else
+            views->push_back(View{chunk, begin, end, numElements});
+        numElements += end - begin;
+    }
+
+    size_t findView(size_t i) const
+    {
+        if (i >= numElements)
+            throw invalid_argument("index " + to_string(i) + " out of range of size " + to_string(numElements));
+        auto itr = std::upper_bound(views->begin(), views->end(), i,
+                                    [](size_t index, const View& view) { return index < view.offset; });
+        return static_cast<size_t>(itr - views->begin()) - 1;
+    }
+
+    shared_ptr<vector<View>> views;
+    size_t numElements;
+};
+
+}  // namespace util
+}  // namespace proptest
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "std.hpp"
+
+namespace proptest {
+
+namespace util {
+
+template <typename Signature, size_t Capacity = 6 * sizeof(void*)>
+class SmallFunction;
+
+/**
+ * @brief Move-only function wrapper that stores small callables inline
+ * @details Callables up to `Capacity` bytes are kept in an internal buffer, so wrapping a lambda with a few captures
+ * doesn't allocate. Larger callables are allocated on the heap as `std::function` would. Like `std::function`, the
+ * wrapped callable is invoked as non-const even through a const wrapper.
+ */
+template <typename R, typename... Args, size_t Capacity>
+class SmallFunction<R(Args...), Capacity> {
+public:
+    SmallFunction() noexcept : ops(nullptr) {}
+
+    template <typename F>
+        requires(!is_same_v<decay_t<F>, SmallFunction>)
+    SmallFunction(F&& f) : ops(nullptr)
+    {
+        using Func = decay_t<F>;
+        if constexpr (fitsInline<Func>()) {
+            new (&storage) Func(util::forward<F>(f));
+            ops = &inlineOps<Func>;
+        } else {
+            *reinterpret_cast<Func**>(&storage) = new Func(util::forward<F>(f));
+            ops = &heapOps<Func>;
+        }
+    }
+
+    SmallFunction(SmallFunction&& other) noexcept : ops(other.ops)
+    {
+        if (ops) {
+            ops->move(&other.storage, &storage);
+            other.ops = nullptr;
+        }
+    }
+
+    SmallFunction& operator=(SmallFunction&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops) {
+                ops->move(&other.storage, &storage);
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    SmallFunction(const SmallFunction&) = delete;
+    SmallFunction& operator=(const SmallFunction&) = delete;
+
+    ~SmallFunction() { reset(); }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    R operator()(Args... args) const
+    {
+        if (!ops)
+            throw std::bad_function_call();
+        return ops->invoke(&storage, util::forward<Args>(args)...);
+    }
+
+private:
+    struct Ops
+    {
+        R (*invoke)(void*, Args&&...);
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void*) noexcept;
+    };
+
+    template <typename Func>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(Func) <= Capacity && alignof(Func) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Func>;
+    }
+
+    template <typename Func>
+    static constexpr Ops inlineOps = {
+        [](void* s, Args&&... args) -> R { return (*static_cast<Func*>(s))(util::forward<Args>(args)...); },
+        [](void* from, void* to) noexcept {
+            new (to) Func(util::move(*static_cast<Func*>(from)));
+            static_cast<Func*>(from)->~Func();
+        },
+        [](void* s) noexcept { static_cast<Func*>(s)->~Func(); }};
+
+    template <typename Func>
+    static constexpr Ops heapOps = {
+        [](void* s, Args&&... args) -> R { return (**static_cast<Func**>(s))(util::forward<Args>(args)...); },
+        [](void* from, void* to) noexcept { *static_cast<Func**>(to) = *static_cast<Func**>(from); },
+        [](void* s) noexcept { delete *static_cast<Func**>(s); }};
+
+    void reset() noexcept
+    {
+        if (ops) {
+            ops->destroy(&storage);
+            ops = nullptr;
+        }
+    }
+
+    const Ops* ops;
+    alignas(std::max_align_t) mutable unsigned char storage[Capacity];
+};
+
+}  // namespace util
+
+}  // namespace proptest
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <any>
+#include <array>
 #include <list>
 #include <vector>
 #include <set>
+#include <unordered_set>
 #include <map>
 #include <tuple>
 #include <type_traits>
@@ -11,6 +13,7 @@
 #include <functional>
 #include <utility>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <iostream>
 #include <iomanip>
@@ -21,8 +24,13 @@
 #include <random>
 #include <limits>
 #include <variant>
+#include <span>
 
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include <concepts>
 
@@ -32,7 +40,10 @@ using std::list;
 using std::map;
 using std::pair;
 using std::set;
+using std::unordered_set;
+using std::array;
 using std::vector;
+using std::span;
 
 using std::tuple;
 using std::tuple_element;
@@ -47,6 +58,7 @@ using std::remove_reference;
 using std::remove_reference_t;
 
 namespace util {
+using std::allocate_shared;
 using std::back_inserter;
 using std::forward;
 using std::make_pair;
@@ -63,6 +75,8 @@ using std::is_lvalue_reference;
 using std::is_pointer;
 using std::is_same;
 using std::is_same_v;
+using std::is_integral_v;
+using std::is_signed_v;
 using std::make_index_sequence;
 using std::same_as;
 
@@ -120,8 +134,19 @@ using std::chrono::steady_clock;
 using std::chrono::duration_cast;
 namespace util {
 using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
 }
 
 using std::invocable;
 
+using std::atomic;
+using std::exception_ptr;
+using std::lock_guard;
+using std::unique_lock;
+using std::mutex;
+using std::condition_variable;
+using std::thread;
+using std::once_flag;
+using std::call_once;
+
 }  // namespace proptest